@@ -15,11 +15,21 @@ extern "C" {
 
 // Includes
 
+#include "kli_abbrev.h"
+#include "kli_async.h"
+#include "kli_binary.h"
+#include "kli_cache.h"
 #include "kli_config.h"
 #include "kli_dispatch.h"
+#include "kli_emit.h"
+#include "kli_help.h"
+#include "kli_input.h"
+#include "kli_macro.h"
 #include "kli_optargs.h"
 #include "kli_parse.h"
 #include "kli_print.h"
+#include "kli_registry.h"
+#include "kli_schedule.h"
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,462 @@
+/**
+ * @file kli.hpp
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI C++ front-end, compile time checked and flattened command tables.
+ * @note Requires C++17. Tables are declared with the C macros prefixed by constexpr, e.g. 'constexpr KLI_BEGIN_COMMAND_TABLE(COMMANDS)'.
+ */
+
+#ifndef KLI_HPP
+#define KLI_HPP
+
+// Includes
+
+#include <cstddef>
+#include <cstdint>
+#include "kli.h"
+
+// Definitions
+
+/**
+ * @brief Macro to declare a flattened table computed at compile time.
+ * @param name Name of the flattened table, to be passed to kli_dispatch_flat.
+ * @param table Top level command table, declared constexpr.
+ * @note Every reachable command, option and argument table is checked during compilation.
+ * @note A failed check is reported by the compiler as a call to a non constexpr kli::error function, naming the problem.
+ */
+#define KLI_CONSTEXPR_FLAT_TABLE(name, table)   inline constexpr auto name##_STORAGE = kli::flatten<table>(); \
+                                                inline constexpr KliFlatTable name = name##_STORAGE.view()
+
+namespace kli {
+
+/**
+ * @brief Table check failures, never constexpr so that a failed check stops compilation at the call site.
+ */
+namespace error {
+inline void command_name_missing() {}
+inline void command_name_empty() {}
+inline void command_name_too_long() {}
+inline void command_name_has_spaces() {}
+inline void command_name_duplicated() {}
+inline void option_name_missing() {}
+inline void option_short_name_not_alphabetic() {}
+inline void option_long_name_invalid() {}
+inline void option_name_duplicated() {}
+inline void option_name_reserved_for_help() {}
+inline void option_argc_out_of_range() {}
+inline void argument_name_missing() {}
+inline void argument_name_has_spaces() {}
+inline void table_too_large() {}
+} // namespace error
+
+namespace detail {
+
+// Definitions
+
+constexpr std::size_t MAX_HASHED_SPAN = 256;            // Larger spans fall back to binary search.
+constexpr std::size_t MAX_HASH_SLOTS = 4096;            // Maximum slot count tried for a single span.
+constexpr std::size_t MAX_HASH_SEEDS = 64;             // Maximum seed tried for a single slot count.
+constexpr std::size_t MAX_HASH_PROBES = 16384;          // Maximum names hashed for a single span, bounds compile time.
+constexpr int SUBCOMMANDS_TAG_SIZE = sizeof("<subcommand(s)>");
+constexpr int OPTIONS_TAG_SIZE = sizeof("<option(s)>");
+constexpr int ARGUMENTS_TAG_SIZE = sizeof("<argument(s)>");
+
+// Structures
+
+/**
+ * @brief Sizes of the flattened storage.
+ */
+struct Layout {
+    std::size_t entries;
+    std::size_t spans;
+    std::size_t names;
+};
+
+/**
+ * @brief Perfect hash parameters of a span, seed 0 if none was found.
+ */
+struct Hash {
+    unsigned short seed;
+    unsigned short mask;
+};
+
+/**
+ * @brief Perfect hash parameters of every span, each table hashed once.
+ */
+template <std::size_t Spans>
+struct SpanHashes {
+    const KliCommand *tables[Spans];
+    Hash hashes[Spans];
+    std::size_t count;
+    std::size_t slots;
+};
+
+/**
+ * @brief Next free position in each storage array while building.
+ */
+struct Cursor {
+    std::size_t entries;
+    std::size_t spans;
+    std::size_t names;
+    std::size_t slots;
+};
+
+// Implementations
+
+constexpr std::size_t length(const char *string) {
+    std::size_t length = 0;
+    while(string[length])
+        ++length;
+    return length;
+}
+
+constexpr int compare(const char *a, const char *b) {
+    while(*a && *a == *b)
+        ++a, ++b;
+    return static_cast<unsigned char>(*a) - static_cast<unsigned char>(*b);
+}
+
+constexpr bool has_spaces(const char *string) {
+    for(; *string; string++)
+        if(*string == ' ')
+            return true;
+    return false;
+}
+
+constexpr bool is_alphabetic(char c) {
+    return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z');
+}
+
+constexpr std::uint32_t hash(const char *name, std::uint32_t seed) {
+    std::uint32_t hash = KLI_FLAT_HASH_BASIS ^ seed;
+    for(; *name; name++)
+        hash = (hash ^ static_cast<unsigned char>(*name)) * KLI_FLAT_HASH_PRIME;
+    return hash ^ (hash >> 16);
+}
+
+constexpr std::size_t count_entries(const KliCommand *table) {
+    std::size_t count = 0;
+    while(table[count].name)
+        ++count;
+
+    // A terminator carrying data is an entry without name
+    if(table[count].description || table[count].subcommands || table[count].options || table[count].arguments || table[count].handler || table[count].flags)
+        error::command_name_missing();
+    return count;
+}
+
+constexpr void check_options(const KliOption *options) {
+    std::size_t count = 0;
+    for(; options[count].shortName || options[count].longName; count++) {
+        const KliOption &option = options[count];
+
+        // Short name must be accepted by the option parser
+        if(option.shortName && !is_alphabetic(option.shortName))
+            error::option_short_name_not_alphabetic();
+
+        // Long name must be accepted by the option parser
+        if(option.longName && (!is_alphabetic(option.longName[0]) || has_spaces(option.longName)))
+            error::option_long_name_invalid();
+
+        // Help option is handled by the dispatcher before options are parsed
+        if(option.shortName == 'h' || (option.longName && !compare(option.longName, "help")))
+            error::option_name_reserved_for_help();
+
+        // Option values must fit in the parsed tokens
+        if(option.argc < 0 || option.argc > KLI_MAX_ARGC)
+            error::option_argc_out_of_range();
+
+        // Names must be unique
+        for(std::size_t i = 0; i < count; i++) {
+            if(option.shortName && options[i].shortName == option.shortName)
+                error::option_name_duplicated();
+            if(option.longName && options[i].longName && !compare(options[i].longName, option.longName))
+                error::option_name_duplicated();
+        }
+    }
+
+    // A terminator carrying data is an option without name
+    if(options[count].argc || options[count].description)
+        error::option_name_missing();
+}
+
+constexpr void check_arguments(const KliArgument *arguments) {
+    std::size_t count = 0;
+    for(; arguments[count].name; count++)
+        if(has_spaces(arguments[count].name))
+            error::argument_name_has_spaces();
+
+    // A terminator carrying data is an argument without name
+    if(arguments[count].description)
+        error::argument_name_missing();
+}
+
+constexpr int table_padding(const KliCommand *table) {
+    int padding = 0;
+    for(const KliCommand *entry = table; entry->name; entry++) {
+        int length = static_cast<int>(detail::length(entry->name));
+        if(entry->subcommands)
+            length += SUBCOMMANDS_TAG_SIZE;
+        else {
+            if(entry->options || entry->arguments)
+                length += 1;
+            if(entry->options)
+                length += OPTIONS_TAG_SIZE - 1;
+            if(entry->options && entry->arguments)
+                length += 1;
+            if(entry->arguments)
+                length += ARGUMENTS_TAG_SIZE - 1;
+        }
+        padding = length > padding ? length : padding;
+    }
+    return padding;
+}
+
+constexpr int optargs_padding(const KliCommand &entry) {
+    int padding = 0;
+    for(const KliOption *option = entry.options; option && (option->shortName || option->longName); option++) {
+        int length = 0;
+        if(option->shortName)
+            length += 2;
+        if(option->shortName && option->longName)
+            length += 1;
+        if(option->longName)
+            length += 2 + static_cast<int>(detail::length(option->longName));
+        if(option->longName && option->argc)
+            length += 1;
+        if(option->argc) {
+            length += ARGUMENTS_TAG_SIZE + 1;
+            for(int x = option->argc; x >= 10; x /= 10)
+                ++length;
+        }
+        padding = length > padding ? length : padding;
+    }
+    for(const KliArgument *argument = entry.arguments; argument && argument->name; argument++) {
+        int length = static_cast<int>(detail::length(argument->name));
+        padding = length > padding ? length : padding;
+    }
+    return padding;
+}
+
+constexpr void check(const KliCommand *table) {
+    std::size_t count = count_entries(table);
+    for(std::size_t i = 0; i < count; i++) {
+        const KliCommand &entry = table[i];
+        std::size_t nameLength = length(entry.name);
+        if(!nameLength)
+            error::command_name_empty();
+        if(nameLength > 0xFF)
+            error::command_name_too_long();
+        if(has_spaces(entry.name))
+            error::command_name_has_spaces();
+        if(entry.options)
+            check_options(entry.options);
+        if(entry.arguments)
+            check_arguments(entry.arguments);
+
+        // Siblings must be unique to be reachable
+        for(std::size_t j = 0; j < i; j++)
+            if(!compare(table[j].name, entry.name))
+                error::command_name_duplicated();
+    }
+
+    // Check children once siblings are valid
+    for(std::size_t i = 0; i < count; i++)
+        if(table[i].subcommands)
+            check(table[i].subcommands);
+}
+
+constexpr Hash find_hash(const KliCommand *table, std::size_t count) {
+    unsigned short stamps[MAX_HASH_SLOTS] = {};
+    std::size_t stamp = 0;
+    std::size_t probes = 0;
+
+    // Empty or large spans are searched by binary search
+    if(!count || count > MAX_HASHED_SPAN)
+        return {0, 0};
+
+    // Try growing slot counts, starting at twice the entry count
+    std::size_t slots = 1;
+    while(slots < 2 * count)
+        slots <<= 1;
+    for(; slots <= MAX_HASH_SLOTS; slots <<= 1) {
+        for(std::uint32_t seed = 1; seed <= MAX_HASH_SEEDS; seed++) {
+
+            // Stamps avoid clearing slots between seeds
+            if(++stamp > 0xFFFF) {
+                for(std::size_t i = 0; i < MAX_HASH_SLOTS; i++)
+                    stamps[i] = 0;
+                stamp = 1;
+            }
+
+            // Seed is perfect if no two names share a slot
+            bool perfect = true;
+            for(std::size_t i = 0; i < count && perfect; i++, probes++) {
+                std::uint32_t slot = hash(table[i].name, seed) & (slots - 1);
+                perfect = stamps[slot] != stamp;
+                stamps[slot] = static_cast<unsigned short>(stamp);
+            }
+            if(perfect)
+                return {static_cast<unsigned short>(seed), static_cast<unsigned short>(slots - 1)};
+
+            // Budget spent, fall back to binary search
+            if(probes >= MAX_HASH_PROBES)
+                return {0, 0};
+        }
+    }
+
+    // No perfect hash found, fall back to binary search
+    return {0, 0};
+}
+
+constexpr void measure(const KliCommand *table, Layout &layout) {
+    std::size_t count = count_entries(table);
+    layout.entries += count;
+    layout.spans += 1;
+    for(std::size_t i = 0; i < count; i++) {
+        layout.names += length(table[i].name) + 1;
+        if(table[i].subcommands)
+            measure(table[i].subcommands, layout);
+    }
+}
+
+template <const KliCommand *Table>
+constexpr Layout measure() {
+    Layout layout = {0, 0, 0};
+    check(Table);
+    measure(Table, layout);
+    return layout;
+}
+
+template <std::size_t Spans>
+constexpr Hash find_span_hash(const SpanHashes<Spans> &hashes, const KliCommand *table) {
+    for(std::size_t i = 0; i < hashes.count; i++)
+        if(hashes.tables[i] == table)
+            return hashes.hashes[i];
+    return {0, 0};
+}
+
+template <std::size_t Spans>
+constexpr void hash_spans(SpanHashes<Spans> &hashes, const KliCommand *table) {
+    std::size_t count = count_entries(table);
+
+    // Tables reached twice reuse their hash
+    bool hashed = false;
+    for(std::size_t i = 0; i < hashes.count && !hashed; i++)
+        hashed = hashes.tables[i] == table;
+    Hash hash = hashed ? find_span_hash(hashes, table) : find_hash(table, count);
+    hashes.slots += hash.seed ? hash.mask + 1u : 0u;
+    if(!hashed) {
+        hashes.tables[hashes.count] = table;
+        hashes.hashes[hashes.count++] = hash;
+    }
+    for(std::size_t i = 0; i < count; i++)
+        if(table[i].subcommands)
+            hash_spans(hashes, table[i].subcommands);
+}
+
+template <const KliCommand *Table, std::size_t Spans>
+constexpr SpanHashes<Spans> hash_spans() {
+    SpanHashes<Spans> hashes = {};
+    hash_spans(hashes, Table);
+    return hashes;
+}
+
+/**
+ * @brief Flattened storage, viewed as a KliFlatTable.
+ */
+template <std::size_t Entries, std::size_t Spans, std::size_t Names, std::size_t Slots>
+struct Storage {
+    char names[Names + 1];
+    KliFlatEntry entries[Entries + 1];
+    KliFlatSpan spans[Spans + 1];
+    const KliCommand *sources[Entries + 1];
+    unsigned char paddings[Entries + 1];
+    unsigned short slots[Slots + 1];
+    const KliCommand *table;
+
+    constexpr KliFlatTable view() const {
+        return {names, entries, spans, sources, table, slots, paddings};
+    }
+};
+
+template <class Storage, class Hashes>
+constexpr void build(Storage &storage, Cursor &cursor, const Hashes &hashes, const KliCommand *table, std::size_t span) {
+    std::size_t count = count_entries(table);
+    std::size_t first = cursor.entries;
+    cursor.entries += count;
+    if(cursor.entries > KLI_FLAT_EMPTY_SLOT || cursor.names > 0xFFFF || cursor.slots > 0xFFFF)
+        error::table_too_large();
+
+    // Sort siblings by name, already checked by measure
+    for(std::size_t i = 0; i < count; i++) {
+        const KliCommand &entry = table[i];
+        std::size_t position = first + i;
+        while(position > first && compare(entry.name, storage.sources[position - 1]->name) < 0) {
+            storage.sources[position] = storage.sources[position - 1];
+            --position;
+        }
+        storage.sources[position] = &entry;
+    }
+
+    // Fill span
+    Hash hash = find_span_hash(hashes, table);
+    KliFlatSpan &flatSpan = storage.spans[span];
+    flatSpan.first = static_cast<unsigned short>(first);
+    flatSpan.count = static_cast<unsigned short>(count);
+    flatSpan.seed = hash.seed;
+    flatSpan.mask = hash.mask;
+    flatSpan.slots = static_cast<unsigned short>(cursor.slots);
+    flatSpan.padding = static_cast<unsigned char>(table_padding(table));
+
+    // Fill perfect hash slots
+    if(hash.seed) {
+        for(std::size_t i = 0; i <= hash.mask; i++)
+            storage.slots[cursor.slots + i] = KLI_FLAT_EMPTY_SLOT;
+        for(std::size_t i = first; i < first + count; i++)
+            storage.slots[cursor.slots + (detail::hash(storage.sources[i]->name, hash.seed) & hash.mask)] = static_cast<unsigned short>(i);
+        cursor.slots += hash.mask + 1u;
+    }
+
+    // Fill entries and names
+    for(std::size_t i = first; i < first + count; i++) {
+        const KliCommand &source = *storage.sources[i];
+        KliFlatEntry &entry = storage.entries[i];
+        entry.name = static_cast<unsigned short>(cursor.names);
+        entry.length = static_cast<unsigned char>(length(source.name));
+        entry.flags = source.subcommands ? KLI_FLAT_SUBCOMMANDS : source.handler ? KLI_FLAT_HANDLER : 0;
+        for(std::size_t c = 0; c <= entry.length; c++)
+            storage.names[cursor.names++] = source.name[c];
+        storage.paddings[i] = source.subcommands ? 0 : static_cast<unsigned char>(optargs_padding(source));
+    }
+
+    // Flatten children spans once siblings are contiguous
+    for(std::size_t i = first; i < first + count; i++) {
+        if(storage.sources[i]->subcommands) {
+            storage.entries[i].span = static_cast<unsigned short>(cursor.spans);
+            build(storage, cursor, hashes, storage.sources[i]->subcommands, cursor.spans++);
+        }
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Check and flatten a constexpr top level command table.
+ * @tparam Table Top level command table.
+ * @return Flattened storage, use its view() method to get the KliFlatTable.
+ */
+template <const KliCommand *Table>
+constexpr auto flatten() {
+    constexpr detail::Layout layout = detail::measure<Table>();
+    constexpr detail::SpanHashes<layout.spans> hashes = detail::hash_spans<Table, layout.spans>();
+    detail::Storage<layout.entries, layout.spans, layout.names, hashes.slots> storage{};
+    detail::Cursor cursor = {0, 1, 0, 0};
+    detail::build(storage, cursor, hashes, Table, 0);
+    storage.table = Table;
+    return storage;
+}
+
+} // namespace kli
+
+#endif /* KLI_HPP */
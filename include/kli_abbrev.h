@@ -0,0 +1,45 @@
+/**
+ * @file kli_abbrev.h
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI abbreviation interface, sorted name index of command tables to accept unique name prefixes.
+ */
+
+#ifndef KLI_ABBREV_H
+#define KLI_ABBREV_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes
+
+#include <stdbool.h>
+#include "kli_dispatch.h"
+
+// Prototypes
+
+/**
+ * @brief Index a top level table and all its subtables once, so kli_dispatch accepts unique name prefixes, e.g. 'mo st'.
+ * @param table Top level table, the source table of a flattened table for kli_dispatch_flat.
+ * @return True if every table fits in the index, false otherwise and the tables left out only accept full names.
+ * @note Built-ins are indexed with the first table. Several top level tables can be indexed, tables already indexed are skipped.
+ * @note Must be called before dispatching, the index is shared by all threads and never changes afterwards.
+ * @note Runtime mounted tables are not indexed, they only accept full names.
+ */
+bool kli_abbrev_init(const KliCommand table[]);
+
+/**
+ * @brief Find the entries of a table whose name starts with a prefix, in O(log n).
+ * @param table Indexed table.
+ * @param prefix Null terminated name prefix.
+ * @param matches Return pointer to the matching entries, contiguous and sorted by name.
+ * @return Number of matching entries, -1 if the table is not indexed.
+ */
+int kli_abbrev_match(const KliCommand table[], const char *prefix, const KliCommand * const **matches);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KLI_ABBREV_H */
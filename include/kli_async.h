@@ -0,0 +1,109 @@
+/**
+ * @file kli_async.h
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI asynchronous command handlers interface.
+ */
+
+#ifndef KLI_ASYNC_H
+#define KLI_ASYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes
+
+#include <stdbool.h>
+#include "kli_dispatch.h"
+
+// Definitions
+
+/**
+ * @brief Value returned by an asynchronous handler which is not done yet.
+ */
+#define KLI_PENDING                                                             kli_pending
+
+/**
+ * @brief Macros to write an asynchronous handler as a resumable function.
+ * @note KLI_ASYNC_BEGIN must be the first statement of the handler and KLI_ASYNC_END the last one.
+ * @note Local variables don't survive KLI_ASYNC_YIELD and KLI_ASYNC_AWAIT, keep them in kli_async_state.
+ * @note A resumable handler must not contain a switch statement spanning a yield, or two yields on the same line.
+ */
+#define KLI_ASYNC_BEGIN                                                         switch(*kli_async_resume()) { case 0:
+
+/**
+ * @brief Return KLI_PENDING, the handler resumes after this statement at the next kli_poll call.
+ */
+#define KLI_ASYNC_YIELD                                                         do { *kli_async_resume() = __LINE__; return KLI_PENDING; case __LINE__:; } while(0)
+
+/**
+ * @brief Return KLI_PENDING until the condition is true, it is evaluated again at each kli_poll call.
+ * @param condition Condition to wait for.
+ */
+#define KLI_ASYNC_AWAIT(condition)                                              while(!(condition)) { *kli_async_resume() = __LINE__; return KLI_PENDING; case __LINE__:; }
+
+/**
+ * @brief End of the resumable handler body, the handler must then return NULL or an error message.
+ */
+#define KLI_ASYNC_END                                                           } *kli_async_resume() = 0
+
+// Variables
+
+/**
+ * @brief Pending marker, only compared by address.
+ */
+extern const char kli_pending[];
+
+// Prototypes
+
+/**
+ * @brief Start an asynchronous handler as a task, and call it a first time.
+ * @param table Top level table the entry was found from.
+ * @param entry Asynchronous handler entry.
+ * @param command Command string, names of the entry and its parents separated by spaces.
+ * @param argc Token count following the command names.
+ * @param argv Tokens following the command names.
+ * @return NULL if the task is done or pending, an error message otherwise.
+ * @note Called by kli_dispatch, tokens are copied so the input line can be reused right away.
+ */
+const char *kli_async_start(const KliCommand table[], const KliCommand *entry, const char *command, int argc, char **argv);
+
+/**
+ * @brief Resume each pending task once.
+ * @return Number of tasks still pending.
+ * @note Must be called by user from the main loop, in the same context as kli_dispatch.
+ * @note Errors are printed, and the output is flushed if any task was resumed.
+ */
+int kli_poll(void);
+
+/**
+ * @brief Cancel all pending tasks and stop all scheduled jobs.
+ * @note Each task is resumed one last time with kli_cancelled returning true, then dropped.
+ * @note Meant to be called when the user hits Ctrl-C.
+ */
+void kli_cancel(void);
+
+/**
+ * @brief Called by asynchronous handlers to know if they were cancelled.
+ * @return True if the running task is being cancelled, false otherwise.
+ */
+bool kli_cancelled(void);
+
+/**
+ * @brief Called by asynchronous handlers to get their private state.
+ * @return Pointer to KLI_ASYNC_STATE_SIZE bytes, zeroed when the task starts.
+ */
+void *kli_async_state(void);
+
+/**
+ * @brief Resume point of the running task, used by the KLI_ASYNC_* macros.
+ * @return Pointer to the resume point.
+ */
+int *kli_async_resume(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KLI_ASYNC_H */
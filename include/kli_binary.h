@@ -0,0 +1,221 @@
+/**
+ * @file kli_binary.h
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI binary frames interface, and host encoder shared with generated command identifiers.
+ */
+
+#ifndef KLI_BINARY_H
+#define KLI_BINARY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "kli_dispatch.h"
+
+// Definitions
+
+/**
+ * @brief Frame layout : SYNC, payload length (u16), payload, CRC-16/CCITT-FALSE of length and payload (u16).
+ * @note Multi-byte values are little endian.
+ * @note Request payload : command identifier (u32), then fields. Response payload : command identifier (u32), status (u8), output text.
+ * @note Field : tag (u8), type (u8), value length (u8), value. Tag is the option index, or KLI_FRAME_ARGUMENT | argument index.
+ */
+#define KLI_FRAME_SYNC                                          0xA5    // First byte of each frame.
+#define KLI_FRAME_HEADER_SIZE                                   3       // Sync and length bytes.
+#define KLI_FRAME_CRC_SIZE                                      2       // CRC bytes.
+#define KLI_FRAME_ARGUMENT                                      0x80    // Tag flag of argument fields.
+#define KLI_FRAME_FLAG                                          0xFF    // Field type of options without value.
+
+/**
+ * @brief Response status.
+ */
+#define KLI_FRAME_OK                                            0       // Handler succeeded.
+#define KLI_FRAME_FAILED                                        1       // Handler returned an error, appended to the output.
+#define KLI_FRAME_UNKNOWN                                       2       // No command with this identifier.
+#define KLI_FRAME_INVALID                                       3       // Fields don't match the command tables.
+
+/**
+ * @brief FNV-1a parameters of command identifiers.
+ */
+#define KLI_ID_BASIS                                            2166136261u
+#define KLI_ID_PRIME                                            16777619u
+
+// Structures
+
+/**
+ * @brief Frame being encoded.
+ */
+typedef struct KliFrame {
+
+    // Output buffer.
+    unsigned char *data;
+
+    // Output buffer size.
+    int size;
+
+    // Bytes written, including the header.
+    int length;
+
+    // Frame didn't fit in the output buffer.
+    bool overflow;
+
+} KliFrame;
+
+// Inline definitions
+
+/**
+ * @brief Compute the stable identifier of a command.
+ * @param path Command names from the top level table, separated by single spaces, e.g. "math add".
+ * @return Command identifier.
+ */
+static inline uint32_t kli_command_id(const char *path) {
+    uint32_t hash = KLI_ID_BASIS;
+    for(const char *c = path; *c; c++)
+        hash = (hash ^ (unsigned char)*c) * KLI_ID_PRIME;
+    return hash;
+}
+
+/**
+ * @brief Update a CRC-16/CCITT-FALSE, bitwise to keep flash usage low.
+ * @param crc CRC of the previous bytes, 0xFFFF to start.
+ * @param data Bytes to add.
+ * @param length Number of bytes.
+ * @return Updated CRC.
+ */
+static inline uint16_t kli_frame_crc(uint16_t crc, const unsigned char *data, int length) {
+    for(int i = 0; i < length; i++) {
+        crc ^= (uint16_t)(data[i] << 8);
+        for(int bit = 0; bit < 8; bit++)
+            crc = crc & 0x8000 ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+/**
+ * @brief Start encoding a request frame.
+ * @param frame Frame state.
+ * @param data Output buffer.
+ * @param size Output buffer size.
+ * @param id Command identifier.
+ */
+static inline void kli_frame_begin(KliFrame *frame, unsigned char *data, int size, uint32_t id) {
+    frame->data = data;
+    frame->size = size;
+    frame->length = KLI_FRAME_HEADER_SIZE + 4;
+    frame->overflow = size < frame->length + KLI_FRAME_CRC_SIZE;
+    if(frame->overflow)
+        return;
+    data[0] = KLI_FRAME_SYNC;
+    for(int i = 0; i < 4; i++)
+        data[KLI_FRAME_HEADER_SIZE + i] = (unsigned char)(id >> (8 * i));
+}
+
+/**
+ * @brief Append a field to a request frame.
+ * @param frame Frame state.
+ * @param tag Option index, or KLI_FRAME_ARGUMENT | argument index.
+ * @param type Value type, KLI_TYPE_* or KLI_FRAME_FLAG.
+ * @param value Value bytes, already little endian.
+ * @param length Value length, at most 255.
+ */
+static inline void kli_frame_field(KliFrame *frame, unsigned char tag, unsigned char type, const void *value, int length) {
+    if(frame->overflow || length > 255 || frame->length + 3 + length + KLI_FRAME_CRC_SIZE > frame->size) {
+        frame->overflow = true;
+        return;
+    }
+    frame->data[frame->length++] = tag;
+    frame->data[frame->length++] = type;
+    frame->data[frame->length++] = (unsigned char)length;
+    memcpy(&frame->data[frame->length], value, length);
+    frame->length += length;
+}
+
+/**
+ * @brief Append a text value field.
+ * @param frame Frame state.
+ * @param tag Option index, or KLI_FRAME_ARGUMENT | argument index.
+ * @param value Null terminated string.
+ */
+static inline void kli_frame_text(KliFrame *frame, unsigned char tag, const char *value) {
+    kli_frame_field(frame, tag, KLI_TYPE_TEXT, value, (int)strlen(value));
+}
+
+/**
+ * @brief Append an integer value field.
+ * @param frame Frame state.
+ * @param tag Option index, or KLI_FRAME_ARGUMENT | argument index.
+ * @param value Integer value.
+ */
+static inline void kli_frame_int(KliFrame *frame, unsigned char tag, int32_t value) {
+    unsigned char bytes[4];
+    for(int i = 0; i < 4; i++)
+        bytes[i] = (unsigned char)((uint32_t)value >> (8 * i));
+    kli_frame_field(frame, tag, KLI_TYPE_INT, bytes, 4);
+}
+
+/**
+ * @brief Append a floating point value field.
+ * @param frame Frame state.
+ * @param tag Option index, or KLI_FRAME_ARGUMENT | argument index.
+ * @param value Floating point value.
+ */
+static inline void kli_frame_float(KliFrame *frame, unsigned char tag, float value) {
+    uint32_t bits;
+    unsigned char bytes[4];
+    memcpy(&bits, &value, 4);
+    for(int i = 0; i < 4; i++)
+        bytes[i] = (unsigned char)(bits >> (8 * i));
+    kli_frame_field(frame, tag, KLI_TYPE_FLOAT, bytes, 4);
+}
+
+/**
+ * @brief Append an option without value.
+ * @param frame Frame state.
+ * @param tag Option index.
+ */
+static inline void kli_frame_flag(KliFrame *frame, unsigned char tag) {
+    kli_frame_field(frame, tag, KLI_FRAME_FLAG, NULL, 0);
+}
+
+/**
+ * @brief Finish a frame, writing its length and CRC.
+ * @param frame Frame state.
+ * @return Frame length in bytes, -1 if it didn't fit in the output buffer.
+ */
+static inline int kli_frame_end(KliFrame *frame) {
+    if(frame->overflow)
+        return -1;
+    int payload = frame->length - KLI_FRAME_HEADER_SIZE;
+    frame->data[1] = (unsigned char)payload;
+    frame->data[2] = (unsigned char)(payload >> 8);
+    uint16_t crc = kli_frame_crc(0xFFFF, &frame->data[1], frame->length - 1);
+    frame->data[frame->length++] = (unsigned char)crc;
+    frame->data[frame->length++] = (unsigned char)(crc >> 8);
+    return frame->length;
+}
+
+// Prototypes
+
+/**
+ * @brief Feed received bytes to the binary frame decoder.
+ * @param table Top level table containing subtables and handlers.
+ * @param data Received bytes.
+ * @param length Number of received bytes.
+ * @note Each valid frame calls its handler through the usual accessors, values being converted to text.
+ * @note Responses are written through kli_write, bytes before a sync byte and frames with a wrong CRC are dropped.
+ * @note Raw and asynchronous commands are not available through frames.
+ */
+void kli_binary_feed(const KliCommand table[], const unsigned char *data, int length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KLI_BINARY_H */
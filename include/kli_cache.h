@@ -0,0 +1,63 @@
+/**
+ * @file kli_cache.h
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI output cache interface, output of cacheable handlers replayed from a user pool.
+ */
+
+#ifndef KLI_CACHE_H
+#define KLI_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Prototypes
+
+/**
+ * @brief Give the output cache its pool, and empty it.
+ * @param memory Pool holding cached outputs, NULL to disable caching.
+ * @param size Pool size in bytes.
+ * @return True if the pool can hold at least one output, false otherwise and caching is disabled.
+ * @note The pool must stay valid until replaced. Oldest outputs are dropped when it is full.
+ * @note The pool is shared by all threads, e.g. kli_server workers, and guarded by a spinlock held only while records are copied.
+ */
+bool kli_output_cache_init(void *memory, size_t size);
+
+/**
+ * @brief Drop all cached outputs, e.g. once the state shown by cacheable handlers changed.
+ * @note Outputs are dropped for all threads.
+ */
+void kli_output_cache_invalidate(void);
+
+/**
+ * @brief Replay the cached output of a handler called with the same tokens, through kli_write.
+ * @param entry Handler entry.
+ * @param argc Option and argument token count.
+ * @param argv Option and argument tokens.
+ * @return True if replayed, false if not cached.
+ * @note Called by kli_dispatch for KLI_COMMAND_CACHEABLE handlers.
+ */
+bool kli_output_cache_replay(const void *entry, int argc, char **argv);
+
+/**
+ * @brief Cache the output of a handler, replacing the oldest outputs if the pool is full.
+ * @param entry Handler entry.
+ * @param argc Option and argument token count.
+ * @param argv Option and argument tokens.
+ * @param output Handler output.
+ * @param length Output length.
+ * @note Called by kli_dispatch once a KLI_COMMAND_CACHEABLE handler succeeded. Outputs larger than the pool are not cached.
+ */
+void kli_output_cache_store(const void *entry, int argc, char **argv, const char *output, int length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KLI_CACHE_H */
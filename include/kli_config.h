@@ -16,9 +16,66 @@ extern "C" {
 
 #define KLI_MAX_LINE_SIZE               256     // 'cli_parse_line' maximum line size.
 #define KLI_MAX_ARGC                    64      // 'cli_parse_line' maximum number of arguments.
+#define KLI_MAX_OPTV                    64      // Maximum number of option values declared by a single option table.
 #define KLI_MAX_PADDING                 128     // Maximum padding used for help messages printing.
 #define KLI_INT32_MAX_DIGITS            12      // Maximum number of digits needed to represent a 32 bit signed integer in base 10.
 #define KLI_MAX_PRINT_SIZE              1024    // Maximum amout of characters print output can hold before a flush.
+#define KLI_RESOLVE_CACHE_SIZE          8       // Number of resolved commands remembered by 'kli_dispatch', 0 to disable.
+#define KLI_RESOLVE_CACHE_DEPTH         8       // Maximum number of command names of a remembered command.
+#define KLI_MAX_JOBS                    4       // Maximum number of commands scheduled by 'every' and 'watch'.
+#define KLI_TICK_MS                     10      // Period of 'kli_tick' calls, in milliseconds.
+#define KLI_WHEEL_SIZE                  32      // Number of slots of the scheduling timer wheel.
+#define KLI_WATCH_PERIOD_MS             1000    // Period of commands scheduled by 'watch', in milliseconds.
+#define KLI_MAX_TASKS                   4       // Maximum number of pending asynchronous handlers.
+#define KLI_ASYNC_STATE_SIZE            32      // Private state size of each asynchronous handler, in bytes.
+#define KLI_SERVER_MAX_SESSIONS         256     // Maximum number of concurrent 'kli_server' sessions.
+#define KLI_SERVER_MAX_WORKERS          16      // Maximum number of 'kli_server' dispatch threads.
+#define KLI_SERVER_OUTPUT_SIZE          4096    // Output bytes a 'kli_server' session can hold while its client is slow.
+#define KLI_SERVER_PROMPT               "> "    // Prompt sent by 'kli_server' after each command.
+#define KLI_MAX_FRAME_SIZE              256     // Maximum size of a binary request frame, header and CRC included.
+#define KLI_HISTORY_SIZE                256     // Bytes of the command history ring of each 'kli_input', lines are null terminated.
+#define KLI_TRIE_NODES                  512     // Nodes of the completion trie of 'kli_input', at most 65535. Names beyond are not completed.
+#define KLI_REGISTRY_SIZE               16      // Slots of the runtime registry hash index, a power of two. At most 3/4 of them are mounted.
+#define KLI_REGISTRY_DEPTH              4       // Maximum number of names of a runtime registry mount path.
+#define KLI_REGISTRY_DEFERRED           4       // Mounts and unmounts a dispatched command can defer until it returns.
+#define KLI_MAX_BINARY_COMMANDS         64      // Maximum number of commands reachable through binary frames, others are unknown.
+#define KLI_MACRO_POOL_SIZE             512     // Bytes of the pool holding macros defined by the 'macro' built-in, steps stored resolved.
+#define KLI_MACRO_NAME_SIZE             16      // Maximum size of a macro name, null terminator included.
+#define KLI_ABBREV_ENTRIES              128     // Entries of the sorted name index built by 'kli_abbrev_init', built-ins included.
+#define KLI_ABBREV_TABLES               32      // Command tables of the sorted name index, built-ins included.
+#define KLI_EMIT_DEPTH                  8       // Maximum nesting of objects and arrays written by the 'kli_emit' functions.
+#define KLI_EMIT_DECIMALS               3       // Decimals of floating point values written as text or JSON.
+
+// Help modes, KLI_HELP_SECTION reads descriptions from the KLI_HELP blob generated by 'kli_tablegen help'.
+#define KLI_HELP_FULL                   0       // Descriptions are kept in tables.
+#define KLI_HELP_SECTION                1       // Descriptions are removed from tables, and read from the help blob.
+#define KLI_HELP_STRIPPED               2       // Descriptions are removed, help prints names only.
+#ifndef KLI_HELP_MODE
+#define KLI_HELP_MODE                   KLI_HELP_FULL
+#endif
+#define KLI_HELP_STACK_SIZE             16      // Decoding stack of compressed descriptions, bounds the nesting of pair codes.
+
+// Placement of the help blob arrays, a separate linker section by default.
+#ifndef KLI_HELP_PLACEMENT
+#if defined(__GNUC__) && !defined(__APPLE__)
+#define KLI_HELP_PLACEMENT              __attribute__((section(".kli_help")))
+#else
+#define KLI_HELP_PLACEMENT
+#endif
+#endif
+
+// Called while the runtime registry waits for another thread, e.g. define as sched_yield() or an RTOS delay.
+#ifndef KLI_REGISTRY_YIELD
+#define KLI_REGISTRY_YIELD()
+#endif
+
+// Storage of dispatch, options and print state, define as _Thread_local to dispatch from several threads.
+#ifdef KLI_THREAD_LOCAL
+#define KLI_THREADED                    1       // State is thread local, several threads can dispatch.
+#else
+#define KLI_THREAD_LOCAL
+#define KLI_THREADED                    0
+#endif
 
 #ifdef __cplusplus
 }
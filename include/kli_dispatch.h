@@ -14,6 +14,7 @@ extern "C" {
 
 // Includes
 
+#include "kli_config.h"
 #include "kli_optargs.h"
 
 // Definitions
@@ -34,7 +35,7 @@ extern "C" {
  * @note Subcommands take precedence over command handlers.
  * @note Command name must not contain spaces.
  */
-#define KLI_ADD_SUBCOMMAND_TABLE(name, description, subcommand)                 {name, description, subcommand, NULL, NULL, NULL},
+#define KLI_ADD_SUBCOMMAND_TABLE(name, description, subcommand)                 {name, KLI_DESCRIPTION(description), subcommand, NULL, NULL, NULL, 0},
 
 /**
  * @brief Macros to add a command handler entry to the current table.
@@ -46,14 +47,51 @@ extern "C" {
  * @note Options and arguments can be set to NULL if not needed.
  * @note Command name must not contain spaces.
  */
-#define KLI_ADD_COMMAND_HANDLER(name, description, options, arguments, handler) {name, description, NULL, options, arguments, handler},
+#define KLI_ADD_COMMAND_HANDLER(name, description, options, arguments, handler) {name, KLI_DESCRIPTION(description), NULL, options, arguments, handler, 0},
+
+/**
+ * @brief Macros to add a raw command handler entry to the current table.
+ * @param name Name of the command as a null terminated string.
+ * @param description Description of the command as a null terminated string.
+ * @param arguments Pointer to the positional arguments table, only used for help messages.
+ * @param handler Pointer to the command handler function.
+ * @note Remaining tokens are not parsed, the handler gets them through kli_get_raw.
+ * @note Command name must not contain spaces.
+ */
+#define KLI_ADD_RAW_COMMAND_HANDLER(name, description, arguments, handler)      {name, KLI_DESCRIPTION(description), NULL, NULL, arguments, handler, KLI_COMMAND_RAW},
+
+/**
+ * @brief Macros to add an asynchronous command handler entry to the current table.
+ * @param name Name of the command as a null terminated string.
+ * @param description Description of the command as a null terminated string.
+ * @param options Pointer to the options table.
+ * @param arguments Pointer to the positional arguments table.
+ * @param handler Pointer to the command handler function.
+ * @note The handler may return KLI_PENDING, it is then called again by kli_poll until it returns NULL or an error.
+ * @note Followed by '&&', the next command is called once the task started, without waiting for it to end.
+ * @note Command name must not contain spaces.
+ */
+#define KLI_ADD_ASYNC_COMMAND_HANDLER(name, description, options, arguments, handler) {name, KLI_DESCRIPTION(description), NULL, options, arguments, handler, KLI_COMMAND_ASYNC},
+
+/**
+ * @brief Macros to add a cacheable command handler entry to the current table.
+ * @param name Name of the command as a null terminated string.
+ * @param description Description of the command as a null terminated string.
+ * @param options Pointer to the options table.
+ * @param arguments Pointer to the positional arguments table.
+ * @param handler Pointer to the command handler function.
+ * @note Once the handler succeeded, its output is replayed for the same tokens until kli_output_cache_invalidate is called.
+ *       The handler must only print, and its output must only depend on its tokens. See kli_output_cache_init.
+ * @note Command name must not contain spaces.
+ */
+#define KLI_ADD_CACHEABLE_COMMAND_HANDLER(name, description, options, arguments, handler) {name, KLI_DESCRIPTION(description), NULL, options, arguments, handler, KLI_COMMAND_CACHEABLE},
 
 /**
  * @brief Macros to end the current command table.
  * @note Must be used to terminate each command table.
  * @note The terminating entry is filled with NULL values.
  */
-#define KLI_END_COMMAND_TABLE                                                   {NULL, NULL, NULL, NULL, NULL, NULL}};
+#define KLI_END_COMMAND_TABLE                                                   {NULL, NULL, NULL, NULL, NULL, NULL, 0}};
 
 /**
  * @brief Macros to declare an external command table.
@@ -62,6 +100,35 @@ extern "C" {
  */
 #define KLI_EXPORT_COMMAND_TABLE(name)                                          extern const KliCommand name[]
 
+/**
+ * @brief Macros to declare an external flattened command table.
+ * @param name Name of the flattened command table.
+ * @note Flattened tables are generated from command tables by the 'tools/kli_tablegen.c' host program.
+ */
+#define KLI_EXPORT_FLAT_TABLE(name)                                             extern const KliFlatTable name
+
+/**
+ * @brief Command entry flags.
+ */
+#define KLI_COMMAND_RAW                                                         0x01    // Handler parses its own tokens, see kli_get_raw.
+#define KLI_COMMAND_ASYNC                                                       0x02    // Handler may return KLI_PENDING, see kli_poll.
+#define KLI_COMMAND_CACHEABLE                                                   0x04    // Handler output is replayed, see kli_output_cache_init.
+
+/**
+ * @brief Flattened entry flags.
+ */
+#define KLI_FLAT_SUBCOMMANDS                                                    0x01    // Entry points to a children span.
+#define KLI_FLAT_HANDLER                                                        0x02    // Entry points to a handler.
+
+/**
+ * @brief Flattened span perfect hash parameters.
+ * @note Slot of a name is computed from hash = BASIS ^ seed, then hash = (hash ^ c) * PRIME for each character c,
+ *       and finally ((hash ^ (hash >> 16)) & mask). Generators must follow the same steps.
+ */
+#define KLI_FLAT_HASH_BASIS                                                     2166136261u
+#define KLI_FLAT_HASH_PRIME                                                     16777619u
+#define KLI_FLAT_EMPTY_SLOT                                                     0xFFFF  // Slot value used when no entry hashes to it.
+
 // Structures
 
 /**
@@ -91,8 +158,112 @@ typedef struct KliCommand {
      */
     const char *(*handler)(void);
 
+    // Command flags, see KLI_COMMAND_RAW, KLI_COMMAND_ASYNC and KLI_COMMAND_CACHEABLE.
+    unsigned char flags;
+
 } KliCommand;
 
+/**
+ * @brief KLI flattened entry structure, only holds the fields needed to route a command.
+ */
+typedef struct KliFlatEntry {
+
+    // Offset of the name in the names pool.
+    unsigned short name;
+
+    // Length of the name, without null termination.
+    unsigned char length;
+
+    // Entry flags, see KLI_FLAT_SUBCOMMANDS and KLI_FLAT_HANDLER.
+    unsigned char flags;
+
+    // Index of the children span, only meaningful with KLI_FLAT_SUBCOMMANDS.
+    unsigned short span;
+
+} KliFlatEntry;
+
+/**
+ * @brief KLI flattened span structure, a range of sibling entries sorted by name.
+ */
+typedef struct KliFlatSpan {
+
+    // Index of the first entry of the span.
+    unsigned short first;
+
+    // Number of entries in the span.
+    unsigned short count;
+
+    // Perfect hash seed, 0 if the span is only searched by binary search.
+    unsigned short seed;
+
+    // Perfect hash slot mask, slot count minus one.
+    unsigned short mask;
+
+    // Offset of the span slots in the slots table.
+    unsigned short slots;
+
+    // Precomputed help padding of the span, 0 if it must be computed when printing.
+    unsigned char padding;
+
+} KliFlatSpan;
+
+/**
+ * @brief KLI flattened command table structure.
+ * @note Names, entries and spans are the hot region read while routing.
+ * @note Sources are the cold region, only read to call handlers or print help.
+ */
+typedef struct KliFlatTable {
+
+    // Names pool, null terminated names stored contiguously.
+    const char *names;
+
+    // Entries, siblings are contiguous and sorted by name.
+    const KliFlatEntry *entries;
+
+    // Spans, the first span holds the top level entries.
+    const KliFlatSpan *spans;
+
+    // Source command entries, indexed like entries.
+    const KliCommand * const *sources;
+
+    // Source top level table, used for help messages.
+    const KliCommand *table;
+
+    // Perfect hash slots holding entry indices, NULL if no span is hashed.
+    const unsigned short *slots;
+
+    // Precomputed options and arguments help padding, indexed like entries. NULL if it must be computed when printing.
+    const unsigned char *paddings;
+
+} KliFlatTable;
+
+/**
+ * @brief KLI resolved command structure, a handler entry with its options and arguments already parsed.
+ * @note Holds its own copy of the tokens, so it can be invoked after the input line is reused.
+ */
+typedef struct KliResolved {
+
+    // Top level table the command was resolved from.
+    const KliCommand *table;
+
+    // Handler entry.
+    const KliCommand *entry;
+
+    // Command string, followed by a copy of the parsed tokens.
+    char line[KLI_MAX_LINE_SIZE];
+
+    // Parsed options and arguments, pointing into line.
+    KliOptargs optargs;
+
+} KliResolved;
+
+// Variables
+
+/**
+ * @brief Built-in commands, looked up before the top level table.
+ */
+KLI_EXPORT_COMMAND_TABLE(KLI_BUILTIN);
+
 // Prototypes
 
 /**
@@ -100,9 +271,122 @@ typedef struct KliCommand {
  * @param table Top level table containing subtables and handlers.
  * @param argc Argument count.
  * @param argv Argument values.
+ * @note Commands can be chained with ';', '&&' (stops once a command failed) and '|' (pipes output to the next command).
+ *       An asynchronous command succeeds for '&&' once its task started, its later result is only printed by kli_poll.
+ * @note Names not found in tables are called as macros, see kli_macro_define.
  */
 void kli_dispatch(const KliCommand table[], int argc, char **argv);
 
+/**
+ * @brief Look for a flattened table entry that match the given arguments.
+ * @param table Flattened table generated from a top level table.
+ * @param argc Argument count.
+ * @param argv Argument values.
+ * @note Behaves like kli_dispatch, but siblings are found by perfect hash or binary search.
+ */
+void kli_dispatch_flat(const KliFlatTable * const table, int argc, char **argv);
+
+/**
+ * @brief Forget the commands remembered by kli_dispatch and kli_dispatch_flat, in every thread.
+ * @note Remembered commands point to table entries, call it after changing a table in place or reusing its memory.
+ * @note Each thread drops its remembered commands at its next dispatch, a dispatch already running is not affected.
+ */
+void kli_resolve_cache_invalidate(void);
+
+/**
+ * @brief Allow or forbid commands running in the background from the calling thread, i.e. asynchronous handlers and the every and watch built-ins.
+ * @param allowed True to allow them, the default, false to fail them with an error.
+ * @return Previous setting, to restore it.
+ * @note Background commands are resumed by kli_poll and kli_tick, whose state is shared by all threads.
+ *       Threads which never call them, e.g. server sessions, must forbid them.
+ */
+bool kli_dispatch_background(bool allowed);
+
+/**
+ * @brief Resolve arguments to a handler entry and parse its options and arguments once.
+ * @param table Top level table containing subtables and handlers, built-ins are also searched.
+ * @param argc Argument count.
+ * @param argv Argument values.
+ * @param resolved Resolved command return pointer.
+ * @return NULL if the command was resolved, an error message otherwise.
+ * @note Raw command handlers can't be resolved, as they need the tokens at each call.
+ * @note Asynchronous command handlers can't be resolved, they are started by kli_dispatch only.
+ */
+const char *kli_resolve(const KliCommand table[], int argc, char **argv, KliResolved *resolved);
+
+/**
+ * @brief Resolve an already found handler entry, copying its tokens and parsing its options and arguments.
+ * @param table Top level table the entry was found from.
+ * @param entry Handler entry.
+ * @param command Command string, names of the entry and its parents separated by spaces.
+ * @param argc Token count following the command names.
+ * @param argv Tokens following the command names.
+ * @param resolved Resolved command return pointer.
+ * @return NULL if the command was resolved, an error message otherwise.
+ */
+const char *kli_resolve_entry(const KliCommand table[], const KliCommand *entry, const char *command, int argc, char **argv, KliResolved *resolved);
+
+/**
+ * @brief Call the handler of a resolved command, with its parsed options and arguments.
+ * @param resolved Command resolved by kli_resolve.
+ * @return NULL if command succeded, an error message otherwise.
+ */
+const char *kli_invoke(const KliResolved *resolved);
+
+/**
+ * @brief Call the handler of an already found entry, with options and arguments already set in a context.
+ * @param table Top level table the entry was found from, needed by built-ins.
+ * @param entry Handler entry.
+ * @param optargs Options and arguments context, bound while the handler runs.
+ * @return NULL if command succeded, an error message otherwise.
+ * @note Used by kli_invoke, and by macros restoring their options and arguments with kli_optargs_set_opt and kli_optargs_set_arg.
+ */
+const char *kli_invoke_entry(const KliCommand table[], const KliCommand *entry, KliOptargs *optargs);
+
+/**
+ * @brief Check a line like kli_dispatch would route and parse it, without calling any handler or printing.
+ * @param table Top level table containing subtables and handlers, built-ins and mounted tables are also searched.
+ * @param argc Argument count, as split by kli_parse_line.
+ * @param argv Argument values.
+ * @return NULL if each command of the line resolves and parses, the first error message otherwise.
+ * @note Typed option and argument values must parse with kli_parse_long or kli_parse_float. Raw command tokens are not checked.
+ * @note The error message is valid until the next call from the same thread.
+ */
+const char *kli_validate(const KliCommand table[], int argc, char **argv);
+
+/**
+ * @brief Set the macro names kli_validate accepts as calls, besides the macros already defined.
+ * @param names Names sorted by strcmp, e.g. the macros defined by a script collected before checking it. NULL for none.
+ * @param count Number of names.
+ * @note Names are shared by all threads and must stay valid while validating, set them before validating from several threads.
+ */
+void kli_validate_macros(const char * const names[], int count);
+
+/**
+ * @brief Check if a line defines a macro, its first name being the macro built-in or a unique prefix of it.
+ * @param table Top level table, full names, mounts and macros are found before prefixes like in kli_dispatch.
+ * @param argc Argument count, as split by kli_parse_line.
+ * @param argv Argument values, the macro name is argv[1] if defined.
+ * @return True if the line defines a macro, false otherwise.
+ */
+bool kli_defines_macro(const KliCommand table[], int argc, char **argv);
+
+/**
+ * @brief Called by user to get the tokens following a raw command.
+ * @param argv Token array return pointer.
+ * @return Token count.
+ * @note Must be called inside a handler added with KLI_ADD_RAW_COMMAND_HANDLER.
+ */
+int kli_get_raw(char ***argv);
+
+/**
+ * @brief Called by user to get the output of the previous command of a pipeline, e.g. 'a | b'.
+ * @param input Output return pointer, NULL if the command is not piped.
+ * @return Output length, truncated to KLI_MAX_PRINT_SIZE - 1.
+ * @note The output is read in place, it is valid until the handler returns.
+ */
+int kli_get_input(const char **input);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,108 @@
+/**
+ * @file kli_emit.h
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI structured output interface, typed values written as text, JSON lines or CBOR without format strings.
+ */
+
+#ifndef KLI_EMIT_H
+#define KLI_EMIT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "kli_print.h"
+
+// Prototypes
+
+/**
+ * @brief Select the encoding of the bound printer, e.g. per server session.
+ * @param encoding KLI_ENCODING_TEXT, KLI_ENCODING_JSON or KLI_ENCODING_CBOR.
+ * @return Previous encoding.
+ */
+unsigned char kli_emit_select(unsigned char encoding);
+
+/**
+ * @brief Get the encoding of the bound printer.
+ * @return KLI_ENCODING_TEXT, KLI_ENCODING_JSON or KLI_ENCODING_CBOR.
+ */
+unsigned char kli_emit_encoding(void);
+
+/**
+ * @brief Open an object, closed by kli_emit_end_object.
+ * @param key Member name inside an object, or at top level. NULL inside arrays.
+ * @note Top level values end a record : a JSON line, a CBOR item or a blank line of text.
+ * @note Objects and arrays nest up to KLI_EMIT_DEPTH levels, deeper values are dropped.
+ */
+void kli_emit_begin_object(const char *key);
+
+/**
+ * @brief Close the last opened object.
+ */
+void kli_emit_end_object(void);
+
+/**
+ * @brief Open an array, closed by kli_emit_end_array.
+ * @param key Member name inside an object, or at top level. NULL inside arrays.
+ */
+void kli_emit_begin_array(const char *key);
+
+/**
+ * @brief Close the last opened array.
+ */
+void kli_emit_end_array(void);
+
+/**
+ * @brief Write a string value.
+ * @param key Member name inside an object, or at top level. NULL inside arrays.
+ * @param value Null terminated string.
+ * @note A keyed value at top level is written as an object holding this single member.
+ */
+void kli_emit_str(const char *key, const char *value);
+
+/**
+ * @brief Write an unsigned integer value.
+ * @param key Member name inside an object, or at top level. NULL inside arrays.
+ * @param value Value.
+ */
+void kli_emit_u32(const char *key, uint32_t value);
+
+/**
+ * @brief Write a signed integer value.
+ * @param key Member name inside an object, or at top level. NULL inside arrays.
+ * @param value Value.
+ */
+void kli_emit_i32(const char *key, int32_t value);
+
+/**
+ * @brief Write a floating point value.
+ * @param key Member name inside an object, or at top level. NULL inside arrays.
+ * @param value Value, written with KLI_EMIT_DECIMALS decimals as text or JSON. Not a number and infinities are JSON null.
+ */
+void kli_emit_float(const char *key, float value);
+
+/**
+ * @brief Write a boolean value.
+ * @param key Member name inside an object, or at top level. NULL inside arrays.
+ * @param value Value.
+ */
+void kli_emit_bool(const char *key, bool value);
+
+/**
+ * @brief Write an error record, e.g. {"error":"unknown command","name":"nope"}, once the encoding is not text.
+ * @param message Error message.
+ * @param name Name the error is about, NULL for none.
+ * @return True if written, false as text so the caller prints its own line.
+ */
+bool kli_emit_error(const char *message, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KLI_EMIT_H */
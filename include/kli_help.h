@@ -0,0 +1,90 @@
+/**
+ * @file kli_help.h
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI help interface, descriptions read from a separate and optionally compressed blob.
+ */
+
+#ifndef KLI_HELP_H
+#define KLI_HELP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "kli_config.h"
+
+// Structures
+
+/**
+ * @brief KLI help blob, generated by 'kli_tablegen help' or 'kli_tablegen help-compressed'.
+ * @note Descriptions are byte strings terminated by a null byte. When compressed, each byte from first to 255
+ *       stands for a pair of bytes, which may be codes themselves.
+ */
+typedef struct KliHelp {
+
+    // Description keys, sorted.
+    const uint32_t *keys;
+
+    // Offset of the description of each key in data, identical descriptions are stored once.
+    const uint32_t *offsets;
+
+    // Descriptions.
+    const unsigned char *data;
+
+    // Pair expanded by each code from first to 255, NULL if not compressed.
+    const unsigned char (*pairs)[2];
+
+    // First code byte, higher than any byte of the descriptions.
+    int first;
+
+    // Number of keys.
+    int count;
+
+} KliHelp;
+
+// Variables
+
+/**
+ * @brief Help blob of the application, defined by the generated source.
+ * @note Only referenced when KLI_HELP_MODE is KLI_HELP_SECTION.
+ */
+extern const KliHelp KLI_HELP;
+
+// Prototypes
+
+/**
+ * @brief Compute the help key of a description.
+ * @param path Command path, names separated by single spaces, e.g. "math add".
+ * @param separator Separator appended to the path, "" for a command, " --" or " -" for an option, " " for an argument.
+ * @param name Name appended after the separator, "" for a command.
+ * @return FNV-1a hash of the concatenated strings.
+ */
+uint32_t kli_help_key(const char *path, const char *separator, const char *name);
+
+/**
+ * @brief Print the description of a key through kli_print.
+ * @param key Help key.
+ * @return True if the description was found, false otherwise or if KLI_HELP_MODE isn't KLI_HELP_SECTION.
+ * @note Compressed descriptions are expanded on the fly, with a stack of KLI_HELP_STACK_SIZE bytes.
+ */
+bool kli_help_print(uint32_t key);
+
+/**
+ * @brief Copy the description of a key, e.g. to write it with kli_emit_str.
+ * @param key Help key.
+ * @param buffer Description return buffer, null terminated.
+ * @param size Buffer size, longer descriptions are truncated.
+ * @return True if the description was found, false otherwise or if KLI_HELP_MODE isn't KLI_HELP_SECTION.
+ */
+bool kli_help_read(uint32_t key, char *buffer, int size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KLI_HELP_H */
@@ -0,0 +1,105 @@
+/**
+ * @file kli_input.h
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI interactive input interface, line editing with tab completion and history.
+ */
+
+#ifndef KLI_INPUT_H
+#define KLI_INPUT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes
+
+#include <stdbool.h>
+#include "kli_config.h"
+#include "kli_dispatch.h"
+
+// Structures
+
+/**
+ * @brief KLI input, the line being edited by an interactive user and its history.
+ * @note Initialize with kli_input_init, one per terminal.
+ */
+typedef struct KliInput {
+
+    // Top level table dispatched and completed.
+    const KliCommand *table;
+
+    // Prompt printed after each command, NULL for none.
+    const char *prompt;
+
+    // Line being edited.
+    char line[KLI_MAX_LINE_SIZE];
+
+    // Character count of the line being edited.
+    int length;
+
+    // Completion trie node reached by the word being typed, -1 if it matches no name.
+    int node;
+
+    // Completion trie node of the handler typed so far, -1 until a handler name is complete.
+    int handler;
+
+    // Previous lines, null terminated, oldest first. Oldest lines are overwritten.
+    char history[KLI_HISTORY_SIZE];
+
+    // Offset of the oldest history byte.
+    int historyStart;
+
+    // History bytes used.
+    int historyLength;
+
+    // History line count.
+    int historyCount;
+
+    // History line shown, 1 for the newest one, 0 while editing a new line.
+    int recall;
+
+    // Escape sequence state, bytes of the sequence received so far.
+    unsigned char escape;
+
+    // Last character received was a carriage return.
+    bool carriageReturn;
+
+    // Interrupt function called on Ctrl-C, kli_cancel after kli_input_init, NULL to only clear the line.
+    void (*interrupt)(void *user);
+
+    // User pointer given to the interrupt function.
+    void *user;
+
+} KliInput;
+
+// Prototypes
+
+/**
+ * @brief Reset an input, and clear its history.
+ * @param input Input to reset.
+ * @param table Top level table containing subtables and handlers.
+ * @param prompt Prompt printed after each command, NULL for none. The first prompt is printed by the caller.
+ * @note Ctrl-C calls kli_cancel, which stops every task and job of the process. Terminals sharing the process, e.g. server
+ *       sessions, must set their own interrupt function or NULL after initialization.
+ */
+void kli_input_init(KliInput *input, const KliCommand table[], const char *prompt);
+
+/**
+ * @brief Feed characters received from an interactive terminal.
+ * @param input Input being edited.
+ * @param data Received characters.
+ * @param length Number of received characters.
+ * @note Characters are echoed, lines ended by '\r', '\n' or "\r\n" are added to history and dispatched.
+ * @note Tab completes command names, then long option names of the handler, from a trie of the built-in and top level tables.
+ *       When the completion is ambiguous, candidates are listed instead.
+ * @note Up and Down arrows recall history lines, Backspace erases, Ctrl-U clears the line, Ctrl-C clears it and calls the interrupt function.
+ * @note Output is flushed before returning.
+ */
+void kli_input_feed(KliInput *input, const char *data, int length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KLI_INPUT_H */
@@ -0,0 +1,75 @@
+/**
+ * @file kli_macro.h
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI macro interface, named command sequences stored already resolved.
+ */
+
+#ifndef KLI_MACRO_H
+#define KLI_MACRO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes
+
+#include <stdbool.h>
+#include "kli_dispatch.h"
+
+// Definitions
+
+/**
+ * @brief Name of the macro built-in, a line starting with it is not split on operators.
+ */
+#define KLI_MACRO_COMMAND                                       "macro"
+
+// Prototypes
+
+/**
+ * @brief Resolve a command sequence once and store it under a name, replacing a macro of the same name.
+ * @param table Top level table containing subtables and handlers, built-ins are also searched.
+ * @param name Macro name, shorter than KLI_MACRO_NAME_SIZE and not used by a top level command.
+ * @param argc Argument count.
+ * @param argv Argument values, commands separated by ';' or '&&'.
+ * @return True if the macro was stored, false otherwise.
+ * @note Each command is stored as its handler entry, its tokens and its parsed options and arguments, so calling
+ *       the macro neither splits, routes nor parses again. Pipes, raw and asynchronous commands can't be stored.
+ * @note Errors are printed through kli_print.
+ * @note Macros are shared by all threads, the pool is only locked while a macro is copied in or out of it.
+ */
+bool kli_macro_define(const KliCommand table[], const char *name, int argc, char **argv);
+
+/**
+ * @brief Remove a macro.
+ * @param name Macro name.
+ * @return True if the macro was removed, false if not defined.
+ */
+bool kli_macro_remove(const char *name);
+
+/**
+ * @brief Check if a macro is defined.
+ * @param name Macro name.
+ * @return True if defined, false otherwise.
+ */
+bool kli_macro_defined(const char *name);
+
+/**
+ * @brief Call the handlers of a macro, '&&' skipping the next command once a command failed.
+ * @param name Macro name.
+ * @param succeeded Return pointer, true if the last called handler succeeded.
+ * @return True if the macro is defined, false otherwise.
+ * @note Called by kli_dispatch when a command name is not found, errors are printed through kli_print.
+ */
+bool kli_macro_call(const char *name, bool *succeeded);
+
+/**
+ * @brief Print defined macros through kli_print.
+ */
+void kli_macro_list(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KLI_MACRO_H */
@@ -16,9 +16,32 @@ extern "C" {
 
 #include <stdbool.h>
 #include <stddef.h>
+#include "kli_config.h"
 
 // Definitions
 
+/**
+ * @brief Token ending options, following tokens are arguments even if they start with '-'.
+ */
+#define KLI_END_OF_OPTIONS                                      "--"
+
+/**
+ * @brief Option and argument value types, used by binary frames and their host encoder.
+ * @note Handlers always get values as strings, binary values are converted to text before being handled.
+ */
+#define KLI_TYPE_TEXT                                           0       // Any string.
+#define KLI_TYPE_INT                                            1       // Signed 32 bit integer.
+#define KLI_TYPE_FLOAT                                          2       // 32 bit floating point number.
+
+/**
+ * @brief Description stored in a table entry, removed unless KLI_HELP_MODE is KLI_HELP_FULL.
+ * @param description Description as a null terminated string.
+ */
+#if KLI_HELP_MODE == KLI_HELP_FULL
+#define KLI_DESCRIPTION(description)                            description
+#else
+#define KLI_DESCRIPTION(description)                            NULL
+#endif
 
 /**
  * @brief Macro to define an option table.
@@ -35,14 +58,25 @@ extern "C" {
  * @param description Description of the option as a null terminated string.
  * @note Option names must not contain spaces.
  */
-#define KLI_ADD_OPTION(shortName, longName, argc, description)  {shortName, longName, argc, description},
+#define KLI_ADD_OPTION(shortName, longName, argc, description)  {shortName, longName, argc, KLI_DESCRIPTION(description), KLI_TYPE_TEXT},
+
+/**
+ * @brief Macro to add an option entry with typed values to the current table.
+ * @param shortName Short name of the option. Use 0 if no short name is needed.
+ * @param longName Long name of the option. Use NULL if no long name is needed.
+ * @param argc Number of expected arguments for this option.
+ * @param type Type of the option values, see KLI_TYPE_TEXT.
+ * @param description Description of the option as a null terminated string.
+ * @note Option names must not contain spaces.
+ */
+#define KLI_ADD_TYPED_OPTION(shortName, longName, argc, type, description) {shortName, longName, argc, KLI_DESCRIPTION(description), type},
 
 /**
  * @brief Macro to end the current option table.
  * @note Must be used to terminate each option table.
  * @note The terminating entry is filled with 0 and NULL values.
  */
-#define KLI_END_OPTION_TABLE                                    {0, NULL, 0, NULL}};
+#define KLI_END_OPTION_TABLE                                    {0, NULL, 0, NULL, 0}};
 
 /**
  * @brief Macro to define an argument table.
@@ -57,14 +91,106 @@ extern "C" {
  * @param description Description of the argument as a null terminated string.
  * @note Argument names must not contain spaces.
  */
-#define KLI_ADD_ARGUMENT(name, description)                     {name, description},
+#define KLI_ADD_ARGUMENT(name, description)                     {name, KLI_DESCRIPTION(description), KLI_TYPE_TEXT},
+
+/**
+ * @brief Macro to add a typed argument entry to the current table.
+ * @param name Name of the argument as a null terminated string.
+ * @param type Type of the argument value, see KLI_TYPE_TEXT.
+ * @param description Description of the argument as a null terminated string.
+ * @note Argument names must not contain spaces.
+ */
+#define KLI_ADD_TYPED_ARGUMENT(name, type, description)         {name, KLI_DESCRIPTION(description), type},
 
 /**
  * @brief Macro to end the current argument table.
  * @note Must be used to terminate each argument table.
  * @note The terminating entry is filled with NULL values.
  */
-#define KLI_END_ARGUMENT_TABLE                                  {NULL, NULL}};
+#define KLI_END_ARGUMENT_TABLE                                  {NULL, NULL, 0}};
+
+/**
+ * @brief Macro to define an option table with its index enumeration and storage layout.
+ * @param name Name of the option table.
+ * @param list X-macro list, calling its parameter once per option as X(id, shortName, longName, argc, description).
+ * @note Each id becomes an enumerator holding the option index, prefixing ids with the table name avoids collisions.
+ * @note Also defines name_OPT_COUNT, and the layout used by KLI_OPTC and KLI_OPTV_OFFSET.
+ */
+#define KLI_DEFINE_OPTION_TABLE(name, list)                     enum { list(KLI_OPTION_ID) name##_OPT_COUNT }; \
+                                                                struct name##_OPTV_LAYOUT { list(KLI_OPTION_FIELD) }; \
+                                                                typedef char name##_OPTV_FITS[sizeof(struct name##_OPTV_LAYOUT) - name##_OPT_COUNT <= KLI_MAX_OPTV ? 1 : -1]; \
+                                                                KLI_BEGIN_OPTION_TABLE(name) list(KLI_OPTION_ROW) KLI_END_OPTION_TABLE
+
+/**
+ * @brief Macro to define an argument table with its index enumeration.
+ * @param name Name of the argument table.
+ * @param list X-macro list, calling its parameter once per argument as X(id, name, description).
+ * @note Each id becomes an enumerator holding the argument index, prefixing ids with the table name avoids collisions.
+ * @note Also defines name_ARG_COUNT.
+ */
+#define KLI_DEFINE_ARGUMENT_TABLE(name, list)                   enum { list(KLI_ARGUMENT_ID) name##_ARG_COUNT }; \
+                                                                KLI_BEGIN_ARGUMENT_TABLE(name) list(KLI_ARGUMENT_ROW) KLI_END_ARGUMENT_TABLE
+
+/**
+ * @brief X-macro expanders used by KLI_DEFINE_OPTION_TABLE and KLI_DEFINE_ARGUMENT_TABLE.
+ * @note Each option is laid out as argc + 1 bytes, so the offset of an option minus its index is the sum of the previous argc.
+ */
+#define KLI_OPTION_ID(id, shortName, longName, argc, description)       id,
+#define KLI_OPTION_FIELD(id, shortName, longName, argc, description)    char id[(argc) + 1];
+#define KLI_OPTION_ROW(id, shortName, longName, argc, description)      KLI_ADD_OPTION(shortName, longName, argc, description)
+#define KLI_ARGUMENT_ID(id, name, description)                          id,
+#define KLI_ARGUMENT_ROW(id, name, description)                         KLI_ADD_ARGUMENT(name, description)
+
+/**
+ * @brief Number of values expected by an option of a table defined with KLI_DEFINE_OPTION_TABLE.
+ * @param table Name of the option table.
+ * @param id Option identifier.
+ */
+#define KLI_OPTC(table, id)                                     (sizeof(((struct table##_OPTV_LAYOUT *)0)->id) - 1)
+
+/**
+ * @brief Offset of the first value of an option in the option values storage.
+ * @param table Name of the option table.
+ * @param id Option identifier.
+ */
+#define KLI_OPTV_OFFSET(table, id)                              (offsetof(struct table##_OPTV_LAYOUT, id) - (id))
+
+/**
+ * @brief Get an option of a table defined with KLI_DEFINE_OPTION_TABLE.
+ * @param table Name of the option table.
+ * @param id Option identifier.
+ * @param optv Array receiving the option values, the compiler rejects arrays smaller than the option argc.
+ * @return True if the option was found during parsing, false otherwise.
+ */
+#define KLI_GET_OPT(table, id, optv)                            ((void)sizeof(char[sizeof(optv) / sizeof((optv)[0]) >= KLI_OPTC(table, id) ? 1 : -1]), \
+                                                                kli_get_opt(id, optv))
+
+/**
+ * @brief Check an option without values of a table defined with KLI_DEFINE_OPTION_TABLE.
+ * @param table Name of the option table.
+ * @param id Option identifier, the compiler rejects options expecting values.
+ * @return True if the option was found during parsing, false otherwise.
+ */
+#define KLI_HAS_OPT(table, id)                                  ((void)sizeof(char[KLI_OPTC(table, id) == 0 ? 1 : -1]), \
+                                                                kli_get_opt(id, NULL))
+
+/**
+ * @brief Get a single option value of a table defined with KLI_DEFINE_OPTION_TABLE, without copy.
+ * @param table Name of the option table.
+ * @param id Option identifier.
+ * @param n Index of the value, from 0 to the option argc excluded.
+ * @return Pointer to the value, NULL if the option was not found during parsing or if n is out of range.
+ */
+#define KLI_OPT_VALUE(table, id, n)                             ((size_t)(n) < KLI_OPTC(table, id) ? \
+                                                                kli_get_optv(id, (int)KLI_OPTV_OFFSET(table, id) + (n)) : (char *)NULL)
+
+/**
+ * @brief Get an argument of a table defined with KLI_DEFINE_ARGUMENT_TABLE.
+ * @param id Argument identifier.
+ * @param argv Argument value return pointer.
+ * @return True if the argument was found during parsing, false otherwise.
+ */
+#define KLI_GET_ARG(id, argv)                                   kli_get_arg(id, argv)
 
 // Structures
 
@@ -85,6 +211,9 @@ typedef struct KliOption {
     // Description of the option.
     const char* description;
 
+    // Type of the option values, see KLI_TYPE_TEXT.
+    unsigned char type;
+
 } KliOption;
 
 /**
@@ -98,8 +227,59 @@ typedef struct KliArgument {
     // Description of the argument.
     const char* description;
 
+    // Type of the argument value, see KLI_TYPE_TEXT.
+    unsigned char type;
+
 } KliArgument;
 
+/**
+ * @brief KLI options and arguments slot layout, computed once per pair of tables.
+ */
+typedef struct KliOptargsLayout {
+
+    // Number of options in the option table.
+    int options;
+
+    // Number of arguments in the argument table.
+    int arguments;
+
+    // Number of option values over the whole option table.
+    int values;
+
+} KliOptargsLayout;
+
+/**
+ * @brief KLI options and arguments context, holding the result of a parse.
+ * @note A default context is used unless another one is bound with kli_optargs_bind.
+ */
+typedef struct KliOptargs {
+
+    // Argument found flags.
+    bool argFound[KLI_MAX_ARGC];
+
+    // Argument values.
+    char *argv[KLI_MAX_ARGC];
+
+    // Option found flags.
+    bool optFound[KLI_MAX_ARGC];
+
+    // Number of values of each option.
+    unsigned short optvLength[KLI_MAX_ARGC];
+
+    // Offset of the first value of each option.
+    unsigned short optvOffset[KLI_MAX_ARGC];
+
+    // Option values, packed by option.
+    char *optv[KLI_MAX_OPTV];
+
+    // Number of options in the parsed option table.
+    int options;
+
+    // Number of arguments in the parsed argument table.
+    int arguments;
+
+} KliOptargs;
+
 // Prototypes
 
 /**
@@ -109,9 +289,63 @@ typedef struct KliArgument {
  * @param argc Argument count.
  * @param argv Argument values.
  * @return True if all argument values could be parsed, false otherwise.
+ * @note Short options can be bundled (-abc) and take their first value attached (-s100), long options take it after '=' (--speed=100).
+ *       Attached values point inside their token, nothing is copied. Tokens following KLI_END_OF_OPTIONS are arguments.
+ *       Any token starting with '-' and a letter is read as short options, text arguments like "-hello" must follow KLI_END_OF_OPTIONS.
  */
 bool kli_optargs(const KliOption options[], const KliArgument arguments[], int argc, char **argv);
 
+/**
+ * @brief Compute the slot layout of a pair of option and argument tables.
+ * @param options Array of options, or NULL.
+ * @param arguments Array of arguments, or NULL.
+ * @param layout Layout return pointer.
+ */
+void kli_optargs_layout(const KliOption options[], const KliArgument arguments[], KliOptargsLayout *layout);
+
+/**
+ * @brief Same as kli_optargs, with a layout previously computed by kli_optargs_layout.
+ * @param options Array of options to find.
+ * @param arguments Array of arguments to find.
+ * @param layout Layout of the options and arguments tables, only the slots it covers are reset.
+ * @param argc Argument count.
+ * @param argv Argument values.
+ * @return True if all argument values could be parsed, false otherwise.
+ */
+bool kli_optargs_resolved(const KliOption options[], const KliArgument arguments[], const KliOptargsLayout *layout, int argc, char **argv);
+
+/**
+ * @brief Reset the bound context for a pair of tables, before setting options and arguments without parsing.
+ * @param options Option table.
+ * @param arguments Argument table.
+ * @return True if the tables fit in the context, false otherwise.
+ */
+bool kli_optargs_reset(const KliOption options[], const KliArgument arguments[]);
+
+/**
+ * @brief Mark an option as found in the bound context, and append a value to it.
+ * @param opti Index of the option in the option table.
+ * @param optv Value to append, NULL for none.
+ * @return True if the option is in the table, false otherwise.
+ * @note The caller must not append more values than the option argc.
+ */
+bool kli_optargs_set_opt(int opti, char *optv);
+
+/**
+ * @brief Set an argument in the bound context.
+ * @param argi Index of the argument in the argument table.
+ * @param argv Argument value.
+ * @return True if the argument is in the table, false otherwise.
+ */
+bool kli_optargs_set_arg(int argi, char *argv);
+
+/**
+ * @brief Select the context written by kli_optargs and read by kli_get_opt and kli_get_arg.
+ * @param optargs Context to bind, NULL to bind the default context back.
+ * @return Previously bound context, NULL for the default one.
+ */
+KliOptargs *kli_optargs_bind(KliOptargs *optargs);
+
 /**
  * @brief Called by user to get parsed option.
  * @param index Index of the option in its option array.
@@ -121,6 +355,15 @@ bool kli_optargs(const KliOption options[], const KliArgument arguments[], int a
  */
 bool kli_get_opt(int index, char **optv);
 
+/**
+ * @brief Called by user to get a single parsed option value from its storage offset.
+ * @param index Index of the option in its option array.
+ * @param offset Offset of the value in the option values storage, see KLI_OPTV_OFFSET.
+ * @return Pointer to the value, NULL if the option was not found during parsing or if the offset is not one of its values.
+ * @note Must be called inside command handler. Prefer KLI_OPT_VALUE which computes the offset at compile time.
+ */
+char *kli_get_optv(int index, int offset);
+
 /**
  * @brief Called by user to get parsed argument.
  * @param index Index of the option in its argument array.
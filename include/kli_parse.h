@@ -16,6 +16,15 @@ extern "C" {
 
 #include <stdbool.h>
 
+// Definitions
+
+/**
+ * @brief Operators tokens, split from the surrounding tokens even without spaces.
+ */
+#define KLI_SEQUENCE_OPERATOR                                                   ";"     // Call next command in any case.
+#define KLI_AND_OPERATOR                                                        "&&"    // Call next command only if the previous one succeeded.
+#define KLI_PIPE_OPERATOR                                                       "|"     // Give the output of the previous command to the next one.
+
 // Prototypes
 
 /**
@@ -23,6 +32,7 @@ extern "C" {
  * @param line Null terminated string.
  * @param argv Array of pointers to argument values.
  * @return Argument count (argc).
+ * @note Tokens are split in place, operators tokens point to constant strings as the line has no room for their terminator.
  */
 int kli_parse_line(char *line, char **argv);
 
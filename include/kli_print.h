@@ -12,6 +12,64 @@
 extern "C" {
 #endif
 
+// Includes
+
+#include <stdbool.h>
+#include "kli_config.h"
+
+// Definitions
+
+/**
+ * @brief Printer encodings, used by the kli_emit functions. Output of kli_print is never encoded.
+ */
+#define KLI_ENCODING_TEXT                                       0       // Human readable lines.
+#define KLI_ENCODING_JSON                                       1       // One JSON value per line.
+#define KLI_ENCODING_CBOR                                       2       // Sequence of CBOR items.
+
+// Structures
+
+/**
+ * @brief KLI printer, an output buffer and where it is flushed to.
+ * @note A default printer flushing through kli_out is used unless another one is bound with kli_print_bind.
+ */
+typedef struct KliPrinter {
+
+    // Formatted output, not yet flushed.
+    char string[KLI_MAX_PRINT_SIZE];
+
+    // Character count of the formatted output.
+    int size;
+
+    // Output function, NULL to use kli_out.
+    void (*out)(void *user, const char *string, int length);
+
+    // User pointer given to the output function.
+    void *user;
+
+    // Keep output in the buffer on flush, used to pipe output to the next command.
+    bool hold;
+
+    // Encoding of the kli_emit functions, see KLI_ENCODING_TEXT.
+    unsigned char encoding;
+
+} KliPrinter;
+
+/**
+ * @brief KLI print mark, position of the output at a given time, see kli_print_since.
+ */
+typedef struct KliPrintMark {
+
+    // Printer bound when marked.
+    const KliPrinter *printer;
+
+    // Character count of the printer when marked.
+    int size;
+
+    // Output breaks when marked, flushes and truncations.
+    unsigned long breaks;
+
+} KliPrintMark;
+
 // Prototypes
 
 /**
@@ -23,10 +81,56 @@ extern "C" {
 void kli_print(const char *format, ...);
 
 /**
- * @brief Flush the print buffer through the platform 'kli_out' function.
+ * @brief Flush the print buffer through the platform 'kli_out' function, or the bound printer output function.
  */
 void kli_flush(void);
 
+/**
+ * @brief Flush pending output, then write bytes as is through the bound printer output.
+ * @param data Bytes to write, may contain null bytes.
+ * @param length Number of bytes.
+ * @note Used for binary responses and replayed output, which must not be formatted again.
+ * @note While the bound printer holds its output, bytes are appended to it as far as they fit.
+ */
+void kli_write(const char *data, int length);
+
+/**
+ * @brief Append bytes as is to the print buffer, flushing it when full.
+ * @param data Bytes to append, may contain null bytes.
+ * @param length Number of bytes.
+ * @note Used by the kli_emit functions, which must not go through format strings.
+ * @note While the bound printer holds its output, bytes are appended as far as they fit.
+ */
+void kli_put(const char *data, int length);
+
+/**
+ * @brief Mark the current position of the output.
+ * @return Print mark.
+ */
+KliPrintMark kli_print_mark(void);
+
+/**
+ * @brief Get the output printed since a mark, still in the buffer of the bound printer.
+ * @param mark Print mark.
+ * @param output First character printed since the mark return pointer.
+ * @return Character count printed since the mark, -1 if the output was flushed, truncated or rebound meanwhile.
+ */
+int kli_print_since(const KliPrintMark *mark, const char **output);
+
+/**
+ * @brief Select the printer written by kli_print and kli_flush.
+ * @param printer Printer to bind, NULL to bind the default printer back.
+ * @return Previously bound printer, NULL for the default one.
+ * @note The binding is per thread when KLI_THREAD_LOCAL is defined as _Thread_local.
+ */
+KliPrinter *kli_print_bind(KliPrinter *printer);
+
+/**
+ * @brief Get the printer written by kli_print and kli_flush.
+ * @return Bound printer, or the default one.
+ */
+KliPrinter *kli_print_bound(void);
+
 #ifdef __cplusplus
 }
 #endif
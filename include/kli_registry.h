@@ -0,0 +1,98 @@
+/**
+ * @file kli_registry.h
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI runtime command registry interface, command tables mounted and unmounted while dispatching.
+ */
+
+#ifndef KLI_REGISTRY_H
+#define KLI_REGISTRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes
+
+#include <stdbool.h>
+#include "kli_dispatch.h"
+
+// Structures
+
+/**
+ * @brief KLI mount, a command table reachable under a path.
+ */
+typedef struct KliMount {
+
+    // Command names leading to the table, separated by single spaces, e.g. "drivers can0".
+    const char *path;
+
+    // Description shown by help.
+    const char *description;
+
+    // Mounted command table.
+    const KliCommand *table;
+
+} KliMount;
+
+// Prototypes
+
+/**
+ * @brief Mount a command table under a path.
+ * @param path Command names separated by single spaces, at most KLI_REGISTRY_DEPTH names.
+ * @param description Description shown by help.
+ * @param table Command table, may contain subtables.
+ * @return True if mounted, false if the path is invalid or already mounted, the registry is full,
+ *         or the table contains asynchronous handlers.
+ * @note Called from a dispatched command, the mount is deferred until the command returns, at most KLI_REGISTRY_DEFERRED
+ *       per command. True then only means the mount was queued.
+ * @note Path, description and table must stay valid until unmounted.
+ * @note Names of the top level and built-in tables take precedence over mount paths.
+ */
+bool kli_registry_mount(const char *path, const char *description, const KliCommand table[]);
+
+/**
+ * @brief Unmount the table mounted under a path.
+ * @param path Path given to kli_registry_mount.
+ * @return True if unmounted, false if not mounted.
+ * @note Waits until no thread dispatches through the previous registry, so the table can be unloaded right after.
+ * @note Called from a dispatched command, the unmount is deferred until the command returns, like kli_registry_mount.
+ *       The table must then stay loaded until the command returned.
+ */
+bool kli_registry_unmount(const char *path);
+
+/**
+ * @brief Enter a read section, mounts read until kli_registry_leave stay valid.
+ * @note Called by kli_dispatch around each command, sections can be nested.
+ */
+void kli_registry_enter(void);
+
+/**
+ * @brief Leave the read section entered by the matching kli_registry_enter.
+ * @note Leaving the outermost section applies the mounts and unmounts deferred inside it, in call order.
+ */
+void kli_registry_leave(void);
+
+/**
+ * @brief Find the mount with the longest path matching the first tokens.
+ * @param argc Token count.
+ * @param argv Tokens.
+ * @param depth Number of tokens matched by the mount path return pointer.
+ * @return Mount, NULL if none matches.
+ * @note Must be called in a read section, each path prefix costs a single hash probe.
+ */
+const KliMount *kli_registry_find(int argc, char **argv, int *depth);
+
+/**
+ * @brief Get the mount held by a slot of the registry index.
+ * @param slot Slot index, from 0 to KLI_REGISTRY_SIZE excluded.
+ * @return Mount, NULL if the slot is free.
+ * @note Must be called in a read section, slots are in hash order.
+ */
+const KliMount *kli_registry_at(int slot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KLI_REGISTRY_H */
@@ -0,0 +1,57 @@
+/**
+ * @file kli_schedule.h
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI periodic command scheduling interface.
+ */
+
+#ifndef KLI_SCHEDULE_H
+#define KLI_SCHEDULE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes
+
+#include <stdbool.h>
+#include "kli_dispatch.h"
+
+// Prototypes
+
+/**
+ * @brief Resolve a command once and schedule its handler periodically.
+ * @param table Top level table containing subtables and handlers.
+ * @param argc Argument count.
+ * @param argv Argument values.
+ * @param period Period in milliseconds, rounded up to a multiple of KLI_TICK_MS.
+ * @param clear Clear the screen before each call, like the 'watch' built-in.
+ * @return Job identifier, or -1 if the command could not be resolved or no job slot is free.
+ * @note Errors are printed through kli_print.
+ */
+int kli_schedule(const KliCommand table[], int argc, char **argv, unsigned long period, bool clear);
+
+/**
+ * @brief Stop a scheduled job.
+ * @param id Job identifier returned by kli_schedule, or -1 to stop all jobs.
+ * @return True if at least one job was stopped, false otherwise.
+ */
+bool kli_unschedule(int id);
+
+/**
+ * @brief Print scheduled jobs through kli_print.
+ */
+void kli_schedule_list(void);
+
+/**
+ * @brief Scheduler tick, must be called by user every KLI_TICK_MS milliseconds.
+ * @note Calls the handlers of due jobs and flushes their output.
+ * @note Must be called from the same context as kli_dispatch, not from an interrupt.
+ */
+void kli_tick(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KLI_SCHEDULE_H */
@@ -0,0 +1,62 @@
+/**
+ * @file kli_server.h
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI multi-session server interface, Linux only.
+ */
+
+#ifndef KLI_SERVER_H
+#define KLI_SERVER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "kli_dispatch.h"
+
+// Prototypes
+
+/**
+ * @brief Prepare the server, and listen on a Unix domain socket.
+ * @param table Top level table containing subtables and handlers, shared by all sessions.
+ * @param path Unix domain socket path, replaced if it exists, or NULL to only serve PTYs.
+ * @param workers Number of dispatch threads, 0 to dispatch from the kli_server_run thread.
+ * @return True if the server is ready, false otherwise with errno set.
+ * @note Dispatching from several workers needs KLI_THREAD_LOCAL defined as _Thread_local for the whole library,
+ *       the server fails to start with EINVAL otherwise.
+ * @note Asynchronous handlers and the every and watch built-ins fail in sessions, see kli_dispatch_background.
+ */
+bool kli_server_start(const KliCommand table[], const char *path, int workers);
+
+/**
+ * @brief Open a pseudo terminal served as one more session.
+ * @param name Slave device name return buffer, e.g. /dev/pts/3.
+ * @param size Size of the name buffer.
+ * @return True if the pseudo terminal is served, false otherwise with errno set.
+ * @note Must be called after kli_server_start. The slave stays open, so clients can come and go.
+ * @note Input is echoed and edited by kli_input, with tab completion and history.
+ */
+bool kli_server_open_pty(char *name, size_t size);
+
+/**
+ * @brief Serve sessions until kli_server_stop is called.
+ * @note Each session gets its own input line, options and arguments context and printer.
+ * @note Output is written without blocking, a slow client only delays its own session.
+ */
+void kli_server_run(void);
+
+/**
+ * @brief Make kli_server_run return, then close all sessions.
+ * @note Async-signal-safe, can be called from a SIGINT or SIGTERM handler.
+ */
+void kli_server_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KLI_SERVER_H */
@@ -0,0 +1,142 @@
+/**
+ * @file kli_abbrev.c
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI abbreviation implementation, entries sorted by name per table, tables sorted by address.
+ */
+
+// Includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "kli_abbrev.h"
+#include "kli_config.h"
+
+// Static structures
+
+/**
+ * @brief Indexed command table.
+ */
+typedef struct IndexedTable {
+
+    // Command table.
+    const KliCommand *table;
+
+    // First entry of the table in the sorted entries.
+    unsigned short first;
+
+    // Number of entries of the table.
+    unsigned short count;
+
+} IndexedTable;
+
+// Static variables
+
+static const KliCommand *entries[KLI_ABBREV_ENTRIES ? KLI_ABBREV_ENTRIES : 1] = {NULL};
+static IndexedTable tables[KLI_ABBREV_TABLES ? KLI_ABBREV_TABLES : 1] = {{NULL, 0, 0}};
+static int entryCount = 0;
+static int tableCount = 0;
+
+// Static prototypes
+
+/**
+ * @brief Index a table, then its subtables.
+ * @param table Command table.
+ * @return True if the table and its subtables fit in the index, false otherwise.
+ */
+static bool index_table(const KliCommand table[]);
+
+/**
+ * @brief Find a table in the index.
+ * @param table Command table.
+ * @param position Return pointer to the position of the table, or to the position it would be inserted at.
+ * @return True if the table is indexed, false otherwise.
+ */
+static bool find_table(const KliCommand table[], int *position);
+
+// Implementations
+
+bool kli_abbrev_init(const KliCommand table[]) {
+    bool indexed = index_table(KLI_BUILTIN);
+    return index_table(table) && indexed;
+}
+
+int kli_abbrev_match(const KliCommand table[], const char *prefix, const KliCommand * const **matches) {
+    int position = 0;
+    if(!find_table(table, &position))
+        return -1;
+
+    // Lower bound of the prefix, names starting with it follow contiguously
+    const IndexedTable * const indexed = &tables[position];
+    const size_t length = strlen(prefix);
+    int low = indexed->first;
+    int high = indexed->first + indexed->count;
+    while(low < high) {
+        int middle = low + (high - low) / 2;
+        if(strcmp(entries[middle]->name, prefix) < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    int end = low;
+    while(end < indexed->first + indexed->count && !strncmp(entries[end]->name, prefix, length))
+        ++end;
+    *matches = &entries[low];
+    return end - low;
+}
+
+// Static definitions
+
+static bool index_table(const KliCommand table[]) {
+    int position = 0;
+    if(find_table(table, &position))
+        return true;
+
+    // Ensure table fits, it is indexed whole or not at all
+    int count = 0;
+    while(table[count].name)
+        ++count;
+    if(tableCount >= KLI_ABBREV_TABLES || entryCount + count > KLI_ABBREV_ENTRIES)
+        return false;
+
+    // Insert entries sorted by name, tables are small and indexed once
+    const int first = entryCount;
+    for(int i = 0; i < count; i++) {
+        int j = first + i;
+        while(j > first && strcmp(entries[j - 1]->name, table[i].name) > 0) {
+            entries[j] = entries[j - 1];
+            --j;
+        }
+        entries[j] = &table[i];
+    }
+    entryCount += count;
+
+    // Insert table sorted by address
+    memmove(&tables[position + 1], &tables[position], (tableCount - position) * sizeof(IndexedTable));
+    tables[position] = (IndexedTable){table, first, count};
+    ++tableCount;
+
+    // Index subtables
+    bool indexed = true;
+    for(const KliCommand *entry = table; entry->name; entry++)
+        if(entry->subcommands)
+            indexed = index_table(entry->subcommands) && indexed;
+    return indexed;
+}
+
+static bool find_table(const KliCommand table[], int *position) {
+
+    // Binary search over table addresses
+    int low = 0;
+    int high = tableCount;
+    while(low < high) {
+        int middle = low + (high - low) / 2;
+        if((uintptr_t)tables[middle].table < (uintptr_t)table)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    *position = low;
+    return low < tableCount && tables[low].table == table;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file kli_async.c
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI asynchronous command handlers implementation.
+ */
+
+// Includes
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "kli_async.h"
+#include "kli_config.h"
+#include "kli_emit.h"
+#include "kli_print.h"
+#include "kli_schedule.h"
+
+// Static structures
+
+/**
+ * @brief Asynchronous task, a resolved command resumed by kli_poll.
+ */
+typedef struct Task {
+
+    // Resolved command, tokens are owned by the task.
+    KliResolved resolved;
+
+    // Handler private state, aligned for any scalar type.
+    union {
+        unsigned char bytes[KLI_ASYNC_STATE_SIZE ? KLI_ASYNC_STATE_SIZE : 1];
+        long long integer;
+        long double real;
+        void *pointer;
+    } state;
+
+    // Resume point used by the KLI_ASYNC_* macros.
+    int resume;
+
+    // Task is being cancelled.
+    bool cancelled;
+
+    // Task slot is in use.
+    bool used;
+
+} Task;
+
+// Variables
+
+const char kli_pending[] = "pending";
+
+// Static variables
+
+static Task tasks[KLI_MAX_TASKS ? KLI_MAX_TASKS : 1] = {0};
+static Task *runningTask = NULL;
+static int idleResume = 0;
+
+// Static prototypes
+
+static const char *resume_task(Task *task);
+
+// Implementations
+
+const char *kli_async_start(const KliCommand table[], const KliCommand *entry, const char *command, int argc, char **argv) {
+
+    // Find a free task slot
+    int id = 0;
+    while(id < KLI_MAX_TASKS && tasks[id].used)
+        ++id;
+    if(id >= KLI_MAX_TASKS)
+        return "no free task, KLI_MAX_TASKS reached";
+
+    // Copy and parse tokens once
+    Task * const task = &tasks[id];
+    const char *error = kli_resolve_entry(table, entry, command, argc, argv, &task->resolved);
+    if(error)
+        return error;
+
+    // First call, keep task only if pending
+    memset(&task->state, 0, sizeof(task->state));
+    task->resume = 0;
+    task->cancelled = false;
+    task->used = true;
+    error = resume_task(task);
+    if(error == KLI_PENDING)
+        return NULL;
+    task->used = false;
+    return error;
+}
+
+int kli_poll(void) {
+    int pending = 0;
+    bool resumed = false;
+
+    // Resume each task once, drop it when done
+    for(int i = 0; i < KLI_MAX_TASKS; i++) {
+        Task * const task = &tasks[i];
+        if(!task->used)
+            continue;
+        resumed = true;
+        const char *error = resume_task(task);
+        if(error == KLI_PENDING) {
+            ++pending;
+            continue;
+        }
+        if(error && !kli_emit_error(error, task->resolved.line))
+            kli_print("\t'%s' - %s\n\n", task->resolved.line, error);
+        task->used = false;
+    }
+
+    // Flush tasks output
+    if(resumed)
+        kli_flush();
+    return pending;
+}
+
+void kli_cancel(void) {
+    bool cancelled = kli_unschedule(-1);
+
+    // Resume each task a last time so it can clean up, then drop it
+    for(int i = 0; i < KLI_MAX_TASKS; i++) {
+        Task * const task = &tasks[i];
+        if(!task->used)
+            continue;
+        cancelled = true;
+        task->cancelled = true;
+        const char *error = resume_task(task);
+        if(!error || error == KLI_PENDING)
+            error = "cancelled";
+        if(!kli_emit_error(error, task->resolved.line))
+            kli_print("\t'%s' - %s\n\n", task->resolved.line, error);
+        task->used = false;
+    }
+
+    // Flush cancellation output
+    if(cancelled)
+        kli_flush();
+}
+
+bool kli_cancelled(void) {
+    return runningTask && runningTask->cancelled;
+}
+
+void *kli_async_state(void) {
+    return runningTask ? runningTask->state.bytes : NULL;
+}
+
+int *kli_async_resume(void) {
+
+    // Outside of a task -> always start from the beginning
+    if(!runningTask) {
+        idleResume = 0;
+        return &idleResume;
+    }
+    return &runningTask->resume;
+}
+
+// Static definitions
+
+static const char *resume_task(Task *task) {
+
+    // Call handler with the task as running task
+    Task * const previous = runningTask;
+    runningTask = task;
+    const char *error = kli_invoke(&task->resolved);
+    runningTask = previous;
+    return error;
+}
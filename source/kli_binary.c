@@ -0,0 +1,344 @@
+/**
+ * @file kli_binary.c
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI binary frames implementation.
+ */
+
+// Includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include "kli_binary.h"
+#include "kli_config.h"
+#include "kli_print.h"
+
+// Static structures
+
+/**
+ * @brief Command reachable through binary frames, sorted by identifier.
+ */
+typedef struct BinaryCommand {
+
+    // Identifier, hash of the command path.
+    uint32_t id;
+
+    // Handler entry.
+    const KliCommand *entry;
+
+} BinaryCommand;
+
+// Static variables
+
+static KLI_THREAD_LOCAL unsigned char frame[KLI_MAX_FRAME_SIZE] = {0};
+static KLI_THREAD_LOCAL int frameLength                        = 0;
+static KLI_THREAD_LOCAL const KliCommand *indexedTable         = NULL;
+static KLI_THREAD_LOCAL BinaryCommand commands[KLI_MAX_BINARY_COMMANDS ? KLI_MAX_BINARY_COMMANDS : 1] = {0};
+static KLI_THREAD_LOCAL int commandCount                       = 0;
+static KLI_THREAD_LOCAL KliResolved resolved                   = {0};
+static KLI_THREAD_LOCAL KliPrinter capture                     = {0};
+
+// Static prototypes
+
+/**
+ * @brief Build the sorted identifier index of a table, once per top level table.
+ * @param table Top level table containing subtables and handlers.
+ */
+static void index_table(const KliCommand table[]);
+
+/**
+ * @brief Add the handlers of a table and its subtables to the index.
+ * @param table Table to walk.
+ * @param path Command path buffer, holding the parent names.
+ * @param length Length of the parent names in the path buffer.
+ */
+static void index_commands(const KliCommand table[], char *path, size_t length);
+
+/**
+ * @brief Find a handler entry from its identifier.
+ * @param id Command identifier.
+ * @return Handler entry, NULL if unknown.
+ */
+static const KliCommand *find_command(uint32_t id);
+
+/**
+ * @brief Handle a complete frame, already checked.
+ * @param table Top level table containing subtables and handlers.
+ */
+static void handle_frame(const KliCommand table[]);
+
+/**
+ * @brief Set options and arguments from the fields of a request payload, values are converted to text.
+ * @param entry Handler entry.
+ * @param fields First field byte.
+ * @param length Length of the fields.
+ * @return True if all fields match the entry tables, false otherwise.
+ */
+static bool set_fields(const KliCommand *entry, const unsigned char *fields, int length);
+
+/**
+ * @brief Convert a field value to text, after the previous values in the resolved line.
+ * @param type Value type.
+ * @param value Value bytes.
+ * @param length Value length.
+ * @param offset Write offset in the resolved line, moved past the text.
+ * @return Text value, NULL if the value doesn't match its type or the line is full.
+ */
+static char *convert_value(unsigned char type, const unsigned char *value, int length, int *offset);
+
+/**
+ * @brief Write a response frame through kli_write.
+ * @param id Command identifier.
+ * @param status Response status.
+ * @param output Output text.
+ * @param length Output length.
+ */
+static void send_response(uint32_t id, unsigned char status, const char *output, int length);
+
+/**
+ * @brief Read a little endian 32 bit value.
+ * @param bytes First byte.
+ * @return Value.
+ */
+static inline uint32_t read_u32(const unsigned char *bytes);
+
+// Implementations
+
+void kli_binary_feed(const KliCommand table[], const unsigned char *data, int length) {
+    for(int i = 0; i < length; i++) {
+
+        // Hunt for a sync byte between frames
+        if(!frameLength && data[i] != KLI_FRAME_SYNC)
+            continue;
+        frame[frameLength++] = data[i];
+        if(frameLength < KLI_FRAME_HEADER_SIZE)
+            continue;
+
+        // Payload must hold an identifier, and the frame must fit -> drop and hunt again
+        const int payload = frame[1] | frame[2] << 8;
+        const int size = KLI_FRAME_HEADER_SIZE + payload + KLI_FRAME_CRC_SIZE;
+        if(payload < 4 || size > KLI_MAX_FRAME_SIZE) {
+            frameLength = 0;
+            continue;
+        }
+        if(frameLength < size)
+            continue;
+
+        // Complete frame, handle it only if the CRC matches
+        const uint16_t crc = frame[size - 2] | frame[size - 1] << 8;
+        if(kli_frame_crc(0xFFFF, &frame[1], size - 3) == crc)
+            handle_frame(table);
+        frameLength = 0;
+    }
+}
+
+// Static definitions
+
+static void index_table(const KliCommand table[]) {
+    if(indexedTable == table)
+        return;
+    char path[KLI_MAX_LINE_SIZE];
+    commandCount = 0;
+    index_commands(table, path, 0);
+    indexedTable = table;
+}
+
+static void index_commands(const KliCommand table[], char *path, size_t length) {
+    for(const KliCommand *entry = table; entry->name; entry++) {
+
+        // Append name to the parent path
+        size_t nameLength = strlen(entry->name);
+        if(length + nameLength + 1 >= KLI_MAX_LINE_SIZE)
+            continue;
+        size_t offset = length;
+        if(length)
+            path[offset++] = ' ';
+        memcpy(&path[offset], entry->name, nameLength + 1);
+
+        // Subtable -> index its handlers
+        if(entry->subcommands) {
+            index_commands(entry->subcommands, path, offset + nameLength);
+            continue;
+        }
+
+        // Only parsed handlers can be called from frames
+        if(!entry->handler || (entry->flags & (KLI_COMMAND_RAW | KLI_COMMAND_ASYNC)) || commandCount >= KLI_MAX_BINARY_COMMANDS)
+            continue;
+
+        // Insert sorted, first entry wins on identifier collision
+        const uint32_t id = kli_command_id(path);
+        int i = commandCount;
+        while(i > 0 && commands[i - 1].id > id)
+            --i;
+        if(i > 0 && commands[i - 1].id == id)
+            continue;
+        memmove(&commands[i + 1], &commands[i], (commandCount - i) * sizeof(commands[0]));
+        commands[i].id = id;
+        commands[i].entry = entry;
+        ++commandCount;
+    }
+}
+
+static const KliCommand *find_command(uint32_t id) {
+    int low = 0, high = commandCount - 1;
+    while(low <= high) {
+        int middle = (low + high) / 2;
+        if(commands[middle].id == id)
+            return commands[middle].entry;
+        if(commands[middle].id < id)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+    return NULL;
+}
+
+static void handle_frame(const KliCommand table[]) {
+    const int payload = frame[1] | frame[2] << 8;
+    const uint32_t id = read_u32(&frame[KLI_FRAME_HEADER_SIZE]);
+
+    // Find command
+    index_table(table);
+    const KliCommand *entry = find_command(id);
+    if(!entry) {
+        send_response(id, KLI_FRAME_UNKNOWN, "unknown command", 15);
+        return;
+    }
+
+    // Set options and arguments in the resolved context
+    resolved.table = table;
+    resolved.entry = entry;
+    resolved.line[0] = '\0';
+    KliOptargs *previous = kli_optargs_bind(&resolved.optargs);
+    bool valid = set_fields(entry, &frame[KLI_FRAME_HEADER_SIZE + 4], payload - 4);
+    kli_optargs_bind(previous);
+    if(!valid) {
+        send_response(id, KLI_FRAME_INVALID, "invalid option(s) or argument(s)", 32);
+        return;
+    }
+
+    // Call handler, capturing its output and error
+    capture.size = 0;
+    capture.hold = true;
+    KliPrinter *previousPrinter = kli_print_bind(&capture);
+    const char *error = kli_invoke(&resolved);
+    if(error)
+        kli_print("%s", error);
+    kli_print_bind(previousPrinter);
+    send_response(id, error ? KLI_FRAME_FAILED : KLI_FRAME_OK, capture.string, capture.size);
+}
+
+static bool set_fields(const KliCommand *entry, const unsigned char *fields, int length) {
+    if(!kli_optargs_reset(entry->options, entry->arguments))
+        return false;
+
+    // Skip the command string slot
+    int offset = 1;
+    for(int i = 0; i < length;) {
+
+        // Field header and value must be in the payload
+        if(i + 3 > length || i + 3 + fields[i + 2] > length)
+            return false;
+        const unsigned char tag = fields[i];
+        const unsigned char type = fields[i + 1];
+        const unsigned char valueLength = fields[i + 2];
+        const unsigned char *value = &fields[i + 3];
+        i += 3 + valueLength;
+
+        // Argument field, type must match
+        if(tag & KLI_FRAME_ARGUMENT) {
+            const int argi = tag & ~KLI_FRAME_ARGUMENT;
+            if(argi >= resolved.optargs.arguments || type != entry->arguments[argi].type)
+                return false;
+            char *text = convert_value(type, value, valueLength, &offset);
+            if(!text || !kli_optargs_set_arg(argi, text))
+                return false;
+            continue;
+        }
+
+        // Option field, flags carry no value
+        if(tag >= resolved.optargs.options)
+            return false;
+        const KliOption * const option = &entry->options[tag];
+        if(!option->argc) {
+            if(type != KLI_FRAME_FLAG || valueLength || !kli_optargs_set_opt(tag, NULL))
+                return false;
+            continue;
+        }
+
+        // Option value, type must match and values must not exceed the option argc
+        if(type != option->type || resolved.optargs.optvLength[tag] >= option->argc)
+            return false;
+        char *text = convert_value(type, value, valueLength, &offset);
+        if(!text || !kli_optargs_set_opt(tag, text))
+            return false;
+    }
+
+    // Options found must have all their values
+    for(int opti = 0; opti < resolved.optargs.options; opti++)
+        if(resolved.optargs.optFound[opti] && resolved.optargs.optvLength[opti] != entry->options[opti].argc)
+            return false;
+    return true;
+}
+
+static char *convert_value(unsigned char type, const unsigned char *value, int length, int *offset) {
+    char * const text = &resolved.line[*offset];
+    const int left = KLI_MAX_LINE_SIZE - *offset;
+    int textLength;
+
+    // Text is copied as is, it must not contain null bytes
+    if(type == KLI_TYPE_TEXT) {
+        if(length + 1 > left || memchr(value, '\0', length))
+            return NULL;
+        memcpy(text, value, length);
+        text[length] = '\0';
+        textLength = length;
+    }
+
+    // Integer and floating point values are formatted as dispatch would have received them
+    else if(type == KLI_TYPE_INT && length == 4)
+        textLength = snprintf(text, left, "%ld", (long)(int32_t)read_u32(value));
+    else if(type == KLI_TYPE_FLOAT && length == 4) {
+        uint32_t bits = read_u32(value);
+        float real;
+        memcpy(&real, &bits, 4);
+        textLength = snprintf(text, left, "%.9g", real);
+    }
+    else
+        return NULL;
+
+    // Line full
+    if(textLength < 0 || textLength + 1 > left)
+        return NULL;
+    *offset += textLength + 1;
+    return text;
+}
+
+static void send_response(uint32_t id, unsigned char status, const char *output, int length) {
+    unsigned char header[KLI_FRAME_HEADER_SIZE + 5];
+    const int payload = 5 + length;
+
+    // Sync, length, identifier and status
+    header[0] = KLI_FRAME_SYNC;
+    header[1] = (unsigned char)payload;
+    header[2] = (unsigned char)(payload >> 8);
+    for(int i = 0; i < 4; i++)
+        header[KLI_FRAME_HEADER_SIZE + i] = (unsigned char)(id >> (8 * i));
+    header[KLI_FRAME_HEADER_SIZE + 4] = status;
+
+    // CRC over length, payload header and output
+    uint16_t crc = kli_frame_crc(0xFFFF, &header[1], sizeof(header) - 1);
+    crc = kli_frame_crc(crc, (const unsigned char *)output, length);
+    const unsigned char trailer[KLI_FRAME_CRC_SIZE] = {(unsigned char)crc, (unsigned char)(crc >> 8)};
+
+    // Write frame in three parts, output is not copied
+    kli_write((const char *)header, sizeof(header));
+    kli_write(output, length);
+    kli_write((const char *)trailer, sizeof(trailer));
+}
+
+static inline uint32_t read_u32(const unsigned char *bytes) {
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
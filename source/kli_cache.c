@@ -0,0 +1,208 @@
+/**
+ * @file kli_cache.c
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI output cache implementation, a single pool shared by all threads behind a spinlock.
+ */
+
+// Includes
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "kli_cache.h"
+#include "kli_config.h"
+#include "kli_dispatch.h"
+#include "kli_print.h"
+
+// Static structures
+
+/**
+ * @brief Cached output, followed by its tokens, each null terminated, then by the output.
+ * @note Records are contiguous from the start of the pool, oldest first.
+ */
+typedef struct Record {
+
+    // Handler entry.
+    const void *entry;
+
+    // Hash of the tokens.
+    uint32_t hash;
+
+    // Length of the tokens, null bytes included.
+    int tokensLength;
+
+    // Length of the output.
+    int outputLength;
+
+} Record;
+
+// Static variables
+
+static unsigned char *pool                  = NULL;
+static size_t poolSize                      = 0;
+static size_t poolUsed                      = 0;
+static atomic_flag locked                   = ATOMIC_FLAG_INIT;
+
+// Static prototypes
+
+/**
+ * @brief Hash the tokens of a call.
+ * @param argc Token count.
+ * @param argv Tokens.
+ * @param length Length of the tokens return pointer, null bytes included.
+ * @return Tokens hash.
+ */
+static uint32_t hash_tokens(int argc, char **argv, int *length);
+
+/**
+ * @brief Check if a record holds the given tokens.
+ * @param record Cached output.
+ * @param argc Token count.
+ * @param argv Tokens.
+ * @return True if all tokens match, false otherwise.
+ */
+static bool match_tokens(const Record *record, int argc, char **argv);
+
+/**
+ * @brief Compute the pool size taken by a record, aligned for the next one.
+ * @param tokensLength Length of the tokens.
+ * @param outputLength Length of the output.
+ * @return Record size.
+ */
+static inline size_t record_size(int tokensLength, int outputLength);
+
+/**
+ * @brief Take the pool lock, held only while records are read or written, never while printing.
+ */
+static inline void lock(void);
+
+/**
+ * @brief Release the pool lock.
+ */
+static inline void unlock(void);
+
+// Implementations
+
+bool kli_output_cache_init(void *memory, size_t size) {
+
+    // Align pool start for records
+    const size_t padding = memory ? (_Alignof(Record) - (uintptr_t)memory % _Alignof(Record)) % _Alignof(Record) : 0;
+    const bool usable = memory && size >= padding + record_size(0, 0);
+    lock();
+    pool = usable ? (unsigned char *)memory + padding : NULL;
+    poolSize = usable ? size - padding : 0;
+    poolUsed = 0;
+    unlock();
+    return usable;
+}
+
+void kli_output_cache_invalidate(void) {
+    lock();
+    poolUsed = 0;
+    unlock();
+}
+
+bool kli_output_cache_replay(const void *entry, int argc, char **argv) {
+    int tokensLength = 0;
+    const uint32_t hash = hash_tokens(argc, argv, &tokensLength);
+    char output[KLI_MAX_PRINT_SIZE];
+    int outputLength = -1;
+
+    // Check records, the hash only selects the candidate, output is copied out of the lock
+    lock();
+    for(size_t offset = 0; offset < poolUsed && outputLength < 0;) {
+        const Record * const record = (const Record *)&pool[offset];
+        offset += record_size(record->tokensLength, record->outputLength);
+        if(record->entry != entry || record->hash != hash || record->tokensLength != tokensLength || !match_tokens(record, argc, argv))
+            continue;
+        outputLength = record->outputLength;
+        memcpy(output, (const char *)(record + 1) + record->tokensLength, outputLength);
+    }
+    unlock();
+
+    // Write output as is, without formatting it again
+    if(outputLength < 0)
+        return false;
+    kli_write(output, outputLength);
+    return true;
+}
+
+void kli_output_cache_store(const void *entry, int argc, char **argv, const char *output, int length) {
+    int tokensLength = 0;
+    const uint32_t hash = hash_tokens(argc, argv, &tokensLength);
+    const size_t size = record_size(tokensLength, length);
+
+    // Outputs come from the print buffer, larger ones could not be replayed
+    if(length > KLI_MAX_PRINT_SIZE)
+        return;
+    lock();
+    if(!pool || size > poolSize) {
+        unlock();
+        return;
+    }
+
+    // Drop oldest records until the new one fits
+    size_t dropped = 0;
+    while(poolUsed - dropped + size > poolSize) {
+        const Record * const record = (const Record *)&pool[dropped];
+        dropped += record_size(record->tokensLength, record->outputLength);
+    }
+    if(dropped) {
+        memmove(pool, &pool[dropped], poolUsed - dropped);
+        poolUsed -= dropped;
+    }
+
+    // Append record, tokens and output
+    Record * const record = (Record *)&pool[poolUsed];
+    *record = (Record){entry, hash, tokensLength, length};
+    char *bytes = (char *)(record + 1);
+    for(int i = 0; i < argc; i++) {
+        const size_t tokenLength = strlen(argv[i]) + 1;
+        memcpy(bytes, argv[i], tokenLength);
+        bytes += tokenLength;
+    }
+    memcpy(bytes, output, length);
+    poolUsed += size;
+    unlock();
+}
+
+// Static definitions
+
+static uint32_t hash_tokens(int argc, char **argv, int *length) {
+    uint32_t hash = KLI_FLAT_HASH_BASIS;
+    *length = 0;
+    for(int i = 0; i < argc; i++) {
+        const char *c = argv[i];
+        for(; *c; c++)
+            hash = (hash ^ (unsigned char)*c) * KLI_FLAT_HASH_PRIME;
+        hash = hash * KLI_FLAT_HASH_PRIME;
+        *length += (int)(c - argv[i]) + 1;
+    }
+    return hash;
+}
+
+static bool match_tokens(const Record *record, int argc, char **argv) {
+    const char *token = (const char *)(record + 1);
+    for(int i = 0; i < argc; i++) {
+        if(strcmp(token, argv[i]))
+            return false;
+        token += strlen(token) + 1;
+    }
+    return true;
+}
+
+static inline size_t record_size(int tokensLength, int outputLength) {
+    const size_t size = sizeof(Record) + tokensLength + outputLength;
+    return (size + _Alignof(Record) - 1) / _Alignof(Record) * _Alignof(Record);
+}
+
+static inline void lock(void) {
+    while(atomic_flag_test_and_set(&locked))
+        ;
+}
+
+static inline void unlock(void) {
+    atomic_flag_clear(&locked);
+}
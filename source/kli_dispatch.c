@@ -7,31 +7,131 @@
 
 // Includes
 
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdio.h>
 #include "kli_dispatch.h"
+#include "kli_abbrev.h"
+#include "kli_async.h"
+#include "kli_cache.h"
 #include "kli_config.h"
+#include "kli_emit.h"
+#include "kli_help.h"
+#include "kli_macro.h"
+#include "kli_parse.h"
 #include "kli_print.h"
+#include "kli_registry.h"
+#include "kli_schedule.h"
+
+// Static structures
+
+/**
+ * @brief Command previously resolved by a dispatch function.
+ */
+typedef struct ResolvedCommand {
+
+    // Top level table the command was resolved from, NULL if the slot is free.
+    const void *table;
+
+    // Hash of the command name tokens.
+    uint32_t hash;
+
+    // Number of command name tokens.
+    int depth;
+
+    // Entries matching each name token, the last one holds the handler.
+    const KliCommand *path[KLI_RESOLVE_CACHE_DEPTH];
+
+    // Help padding of the handler entry, 0 if it must be computed.
+    int padding;
+
+    // Options and arguments slot layout of the handler entry.
+    KliOptargsLayout layout;
+
+    // Last use, least recently used slot is replaced first.
+    unsigned long used;
+
+} ResolvedCommand;
 
 // Static prototypes
 
+static void dispatch_line(const KliCommand table[], const KliFlatTable *flat, int argc, char **argv);
+static bool dispatch_pipeline(const KliCommand table[], const KliFlatTable *flat, int argc, char **argv);
+static bool dispatch_command(const KliCommand table[], const KliFlatTable *flat, int argc, char **argv);
 static void reset_caches(void);
-static void call_handler(const KliCommand * const entry, int argc, char **argv);
+static void call_handler(const KliCommand * const entry, const KliOptargsLayout * const layout, int argc, char **argv, int padding);
+static void append_command(const char *name, size_t length);
+static void resolve_command(void);
+static bool find_resolved(const void *table, int argc, char **argv);
+static void remember_resolved(const KliOptargsLayout * const layout, int padding);
 static bool find_entry(const KliCommand table[], int argc, char **argv);
+static void enter_entry(const KliCommand * const entry, int argc, char **argv);
+static bool find_mounted_entry(int argc, char **argv);
+static int search_flat_span(const KliFlatTable * const table, const KliFlatSpan * const span, const char *token);
+static bool find_flat_entry(const KliFlatTable * const table, const KliFlatSpan * const span, int argc, char **argv);
+static void enter_flat_entry(const KliFlatTable * const table, int index, int argc, char **argv);
+static bool find_abbreviated_entry(const KliCommand table[], bool top, int argc, char **argv);
+static bool find_abbreviated_flat_entry(const KliFlatTable * const table, const KliFlatSpan * const span, bool top, int argc, char **argv);
+static void print_candidate(const char *name);
 static int get_table_padding(const KliCommand table[]);
 static int get_optargs_padding(const KliCommand * const entry);
 static void print_table(const KliCommand table[], int padding);
-static void print_entry(const KliCommand * const entry);
+static void print_mounts(int padding);
+static int get_mounts_padding(void);
+static void print_entry(const KliCommand * const entry, int padding);
+static void print_help_line(int padding, const char *text, const char *description, const char *separator, const char *name);
+static bool emit_error(const char *message, const char *name);
+static void open_error(const char *message, const char *name);
+static void emit_table(const KliCommand table[]);
+static void emit_mounts(void);
+static void emit_entry(const KliCommand * const entry);
+static void emit_description(const char *description, const char *separator, const char *name);
+static int get_flat_padding(const KliFlatTable * const table, int index);
+static const KliCommand *find_handler_entry(const KliCommand table[], int *argc, char ***argv, const char **error);
+static bool validate_command(const KliCommand table[], int argc, char **argv);
+static bool find_validated_macro(const char *name);
+static bool validate_entry(const KliCommand *entry, char **names, int argc, char **argv);
+static bool validate_optargs(const KliCommand * const entry, int argc, char **argv);
+static bool validate_value(unsigned char type, const char *value);
+static const KliCommand *match_abbreviated(const KliCommand table[], bool top, const char *prefix, int *count);
+static void print_names(char **first, char **last);
 
 // Built in commands
 
 static const char *help_handler(void);
 static const char *clear_handler(void);
+static const char *every_handler(void);
+static const char *watch_handler(void);
+static const char *macro_handler(void);
+static const char *encoding_handler(void);
+
+KLI_BEGIN_ARGUMENT_TABLE(EVERY_ARGUMENTS)
+KLI_ADD_ARGUMENT("period", "Period in milliseconds, 'stop' to stop jobs, or nothing to list jobs.")
+KLI_ADD_ARGUMENT("command", "Command called each period, or job to stop ('all' to stop all jobs).")
+KLI_END_ARGUMENT_TABLE
+
+KLI_BEGIN_ARGUMENT_TABLE(WATCH_ARGUMENTS)
+KLI_ADD_ARGUMENT("command", "Command called each KLI_WATCH_PERIOD_MS milliseconds after clearing the screen.")
+KLI_END_ARGUMENT_TABLE
+
+KLI_BEGIN_ARGUMENT_TABLE(MACRO_ARGUMENTS)
+KLI_ADD_ARGUMENT("name", "Macro called by its name, or nothing to list macros.")
+KLI_ADD_ARGUMENT("command", "Commands separated by ';' or '&&', resolved once, or nothing to remove the macro.")
+KLI_END_ARGUMENT_TABLE
+
+KLI_BEGIN_ARGUMENT_TABLE(ENCODING_ARGUMENTS)
+KLI_ADD_ARGUMENT("encoding", "'text', 'json' or 'cbor', or nothing to show the current encoding.")
+KLI_END_ARGUMENT_TABLE
 
 KLI_BEGIN_COMMAND_TABLE(KLI_BUILTIN)
 KLI_ADD_COMMAND_HANDLER("help", "Show commands. Use <command> -h or --help to show (sub)command help.", NULL, NULL, help_handler)
 KLI_ADD_COMMAND_HANDLER("clear", "Clear screen and home cursor through VT100 codes.", NULL, NULL, clear_handler)
+KLI_ADD_RAW_COMMAND_HANDLER("every", "Call a command periodically, without parsing it again.", EVERY_ARGUMENTS, every_handler)
+KLI_ADD_RAW_COMMAND_HANDLER("watch", "Clear the screen and call a command periodically.", WATCH_ARGUMENTS, watch_handler)
+KLI_ADD_RAW_COMMAND_HANDLER("macro", "Store commands under a name, called without parsing them again.", MACRO_ARGUMENTS, macro_handler)
+KLI_ADD_COMMAND_HANDLER("encoding", "Select how errors, help and structured output are written.", NULL, ENCODING_ARGUMENTS, encoding_handler)
 KLI_END_COMMAND_TABLE
 
 // Static constants
@@ -45,43 +145,460 @@ static const char ARGUMENTS_BEACON[]    = "[ARGUMENT(S)]";
 static const char SUBCOMMANDS_TAG[]     = "<subcommand(s)>";
 static const char OPTIONS_TAG[]         = "<option(s)>";
 static const char ARGUMENTS_TAG[]       = "<argument(s)>";
+static const char * const ENCODINGS[]   = {"text", "json", "cbor"};
 
 // Static variables
 
-static const KliCommand * topTable      = NULL;
-static char command[KLI_MAX_LINE_SIZE]  = {0};
-static size_t commandEndIndex           = 0;
+static KLI_THREAD_LOCAL const KliCommand * topTable      = NULL;
+static KLI_THREAD_LOCAL int topPadding                   = 0;
+static KLI_THREAD_LOCAL char command[KLI_MAX_LINE_SIZE]  = {0};
+static KLI_THREAD_LOCAL size_t commandEndIndex           = 0;
+static KLI_THREAD_LOCAL const void *resolvingTable       = NULL;
+static KLI_THREAD_LOCAL const KliCommand *resolvingPath[KLI_RESOLVE_CACHE_DEPTH] = {NULL};
+static KLI_THREAD_LOCAL int resolvingDepth               = 0;
+static KLI_THREAD_LOCAL const ResolvedCommand *unresolvedCommand = NULL;
+static KLI_THREAD_LOCAL int rawArgc                      = 0;
+static KLI_THREAD_LOCAL char **rawArgv                   = NULL;
+static KLI_THREAD_LOCAL bool commandFailed               = false;
+static KLI_THREAD_LOCAL const char *pipeInput            = NULL;
+static KLI_THREAD_LOCAL int pipeInputLength              = 0;
+static KLI_THREAD_LOCAL KliPrinter pipes[2]              = {0};
+static KLI_THREAD_LOCAL ResolvedCommand resolvedCommands[KLI_RESOLVE_CACHE_SIZE ? KLI_RESOLVE_CACHE_SIZE : 1] = {0};
+static KLI_THREAD_LOCAL unsigned long resolvedClock      = 0;
+static KLI_THREAD_LOCAL unsigned resolvedGeneration      = 0;
+static KLI_THREAD_LOCAL KliPrinter validationError       = {0};
+static KLI_THREAD_LOCAL bool backgroundAllowed           = true;
+static atomic_uint resolveGeneration                     = 0;
+static const char * const *validatedMacros               = NULL;
+static int validatedMacroCount                           = 0;
 
 // Implementations
 
 void kli_dispatch(const KliCommand table[], int argc, char **argv) {
-    
+    dispatch_line(table, NULL, argc, argv);
+}
+
+void kli_dispatch_flat(const KliFlatTable * const table, int argc, char **argv) {
+    dispatch_line(table->table, table, argc, argv);
+}
+
+void kli_resolve_cache_invalidate(void) {
+    atomic_fetch_add(&resolveGeneration, 1);
+}
+
+bool kli_dispatch_background(bool allowed) {
+    const bool previous = backgroundAllowed;
+    backgroundAllowed = allowed;
+    return previous;
+}
+
+const char *kli_resolve(const KliCommand table[], int argc, char **argv, KliResolved *resolved) {
+    const char *error = NULL;
+    size_t length = 0;
+
+    // Find handler entry in built-ins, then in commands
+    int remainingArgc = argc;
+    char **remainingArgv = argv;
+    const KliCommand *entry = find_handler_entry(KLI_BUILTIN, &remainingArgc, &remainingArgv, &error);
+    if(!entry && !error) {
+        remainingArgc = argc;
+        remainingArgv = argv;
+        entry = find_handler_entry(table, &remainingArgc, &remainingArgv, &error);
+    }
+    if(!entry)
+        return error ? error : "unknown command";
+    if(entry->flags & KLI_COMMAND_RAW)
+        return "raw commands can't be resolved";
+    if(entry->flags & KLI_COMMAND_ASYNC)
+        return "asynchronous commands can't be resolved";
+
+    // Build command string from names, separated by spaces
+    for(int i = 0; i < argc - remainingArgc; i++) {
+        size_t nameLength = strlen(argv[i]);
+        if(length + nameLength + 1 > KLI_MAX_LINE_SIZE)
+            return "command too long";
+        memcpy(&resolved->line[length], argv[i], nameLength);
+        length += nameLength;
+        resolved->line[length++] = ' ';
+    }
+    resolved->line[length - 1] = '\0';
+    return kli_resolve_entry(table, entry, resolved->line, remainingArgc, remainingArgv, resolved);
+}
+
+const char *kli_resolve_entry(const KliCommand table[], const KliCommand *entry, const char *command, int argc, char **argv, KliResolved *resolved) {
+    size_t length = strlen(command) + 1;
+    if(length > KLI_MAX_LINE_SIZE)
+        return "command too long";
+
+    // Copy command string, command may already point to the resolved line
+    resolved->table = table;
+    resolved->entry = entry;
+    memmove(resolved->line, command, length);
+
+    // Copy each token after the command string
+    char *tokens[KLI_MAX_ARGC] = {NULL};
+    for(int i = 0; i < argc; i++) {
+        size_t tokenLength = strlen(argv[i]) + 1;
+        if(length + tokenLength > KLI_MAX_LINE_SIZE)
+            return "command too long";
+        tokens[i] = memcpy(&resolved->line[length], argv[i], tokenLength);
+        length += tokenLength;
+    }
+
+    // Parse options and arguments once, in the resolved context
+    KliOptargs *previous = kli_optargs_bind(&resolved->optargs);
+    bool parsed = kli_optargs(entry->options, entry->arguments, argc, tokens);
+    kli_optargs_bind(previous);
+    return parsed ? NULL : "invalid option(s) or argument(s)";
+}
+
+const char *kli_invoke(const KliResolved *resolved) {
+    return kli_invoke_entry(resolved->table, resolved->entry, (KliOptargs *)&resolved->optargs);
+}
+
+const char *kli_invoke_entry(const KliCommand table[], const KliCommand *entry, KliOptargs *optargs) {
+
+    // Call handler with its parsed options and arguments, built-ins may need the top level table
+    const KliCommand *previousTable = topTable;
+    KliOptargs *previous = kli_optargs_bind(optargs);
+    topTable = table;
+    const char *error = entry->handler();
+    topTable = previousTable;
+    kli_optargs_bind(previous);
+    return error;
+}
+
+const char *kli_validate(const KliCommand table[], int argc, char **argv) {
+    bool valid = true;
+    bool piped = false;
+    int start = 0;
+
+    // Errors are printed in a held printer, never flushed
+    validationError.size = 0;
+    validationError.string[0] = '\0';
+    validationError.hold = true;
+    KliPrinter *previous = kli_print_bind(&validationError);
+
+    // Macro definition -> check its commands, raw tokens otherwise
+    if(argc >= 2 && kli_defines_macro(table, argc, argv))
+        start = 2;
+
+    // Commands end at an operator or at the end of the line
+    for(int i = start; i <= argc && valid; i++) {
+        bool isEnd = i == argc;
+        bool isPipe = !isEnd && !strcmp(argv[i], KLI_PIPE_OPERATOR);
+        if(!isEnd && !isPipe && strcmp(argv[i], KLI_SEQUENCE_OPERATOR) && strcmp(argv[i], KLI_AND_OPERATOR))
+            continue;
+
+        // Empty commands are skipped, except on either side of a pipe
+        if(i == start && (isPipe || piped)) {
+            kli_print("'%s' - expected command.", KLI_PIPE_OPERATOR);
+            valid = false;
+        }
+        else if(i > start)
+            valid = validate_command(table, i - start, &argv[start]);
+        piped = isPipe;
+        start = i + 1;
+    }
+    kli_print_bind(previous);
+    if(valid)
+        return NULL;
+
+    // Keep the first error line, without indentation
+    char *error = &validationError.string[strspn(validationError.string, "\t")];
+    error[strcspn(error, "\n")] = '\0';
+    return error;
+}
+
+void kli_validate_macros(const char * const names[], int count) {
+    validatedMacros = names;
+    validatedMacroCount = names ? count : 0;
+}
+
+bool kli_defines_macro(const KliCommand table[], int argc, char **argv) {
+    if(!argc)
+        return false;
+    if(!strcmp(argv[0], KLI_MACRO_COMMAND))
+        return true;
+
+    // Full names, mounts and macros are found before prefixes, like in dispatch_command
+    for(const KliCommand *entry = KLI_BUILTIN; entry->name; entry++)
+        if(!strcmp(argv[0], entry->name))
+            return false;
+    for(const KliCommand *entry = table; entry->name; entry++)
+        if(!strcmp(argv[0], entry->name))
+            return false;
+    int depth = 0;
+    kli_registry_enter();
+    const bool mounted = kli_registry_find(argc, argv, &depth) != NULL;
+    kli_registry_leave();
+    if(mounted || kli_macro_defined(argv[0]) || find_validated_macro(argv[0]))
+        return false;
+
+    // Unique prefix of the built-in -> operators belong to the stored commands too
+    int count = 0;
+    const KliCommand * const entry = match_abbreviated(table, true, argv[0], &count);
+    return entry && !strcmp(entry->name, KLI_MACRO_COMMAND);
+}
+
+int kli_get_raw(char ***argv) {
+    *argv = rawArgv;
+    return rawArgc;
+}
+
+int kli_get_input(const char **input) {
+    *input = pipeInput;
+    return pipeInputLength;
+}
+
+// Static definitions
+
+static void dispatch_line(const KliCommand table[], const KliFlatTable *flat, int argc, char **argv) {
+    bool succeeded = true;
+    bool skipping = false;
+    int start = 0;
+
+    // Macro definition -> operators belong to the stored commands
+    if(kli_defines_macro(table, argc, argv)) {
+        dispatch_command(table, flat, argc, argv);
+        return;
+    }
+
+    // Pipelines end at a sequence operator or at the end of the line
+    for(int i = 0; i <= argc; i++) {
+        bool isEnd = i == argc;
+        bool isSequence = !isEnd && !strcmp(argv[i], KLI_SEQUENCE_OPERATOR);
+        bool isAnd = !isEnd && !strcmp(argv[i], KLI_AND_OPERATOR);
+        if(!isEnd && !isSequence && !isAnd)
+            continue;
+
+        // Call pipeline, unless a previous '&&' failed
+        if(!skipping && i > start)
+            succeeded = dispatch_pipeline(table, flat, i - start, &argv[start]);
+
+        // '&&' skips the next pipeline once a pipeline failed, ';' always calls it
+        skipping = isAnd && (skipping || !succeeded);
+        start = i + 1;
+    }
+}
+
+static bool dispatch_pipeline(const KliCommand table[], const KliFlatTable *flat, int argc, char **argv) {
+    const char *input = NULL;
+    int inputLength = 0;
+    int start = 0;
+    int stage = 0;
+
+    // Commands end at a pipe operator or at the end of the pipeline
+    for(int i = 0; i <= argc; i++) {
+        bool isEnd = i == argc;
+        if(!isEnd && strcmp(argv[i], KLI_PIPE_OPERATOR))
+            continue;
+        if(i == start) {
+            if(!emit_error("expected command", KLI_PIPE_OPERATOR))
+                kli_print("\t'%s' - expected command.\n\n", KLI_PIPE_OPERATOR);
+            return false;
+        }
+
+        // Each command but the last prints in a held pipe, read by the next one in place
+        KliPrinter * const pipe = &pipes[stage % 2];
+        KliPrinter *previous = NULL;
+        if(!isEnd) {
+            pipe->size = 0;
+            pipe->string[0] = '\0';
+            pipe->hold = true;
+            previous = kli_print_bind(pipe);
+        }
+        pipeInput = input;
+        pipeInputLength = inputLength;
+        bool succeeded = dispatch_command(table, flat, i - start, &argv[start]);
+        pipeInput = NULL;
+        pipeInputLength = 0;
+        if(isEnd)
+            return succeeded;
+        kli_print_bind(previous);
+
+        // Failed command -> show its output instead of piping it
+        if(!succeeded) {
+            kli_print("%.*s", pipe->size, pipe->string);
+            return false;
+        }
+        input = pipe->string;
+        inputLength = pipe->size;
+        start = i + 1;
+        ++stage;
+    }
+    return true;
+}
+
+static bool dispatch_command(const KliCommand table[], const KliFlatTable *flat, int argc, char **argv) {
+    const void *key = flat ? (const void *)flat : (const void *)table;
+    commandFailed = false;
+
     // No argument(s) -> early return
     if(!argc)
         goto KLI_DISPATCH_END;
 
-    // Lookup for entry in builts-in, if found -> early return
+    // Mounted tables stay valid until the command returns
+    kli_registry_enter();
+
+    // Lookup for an already resolved command, if found -> early return
     topTable = table;
+    topPadding = flat ? flat->spans[0].padding : 0;
+    if(find_resolved(key, argc, argv))
+        goto KLI_DISPATCH_END;
+
+    // Lookup for entry in builts-in, if found -> early return
+    resolvingTable = key;
     if(find_entry(KLI_BUILTIN, argc, argv))
         goto KLI_DISPATCH_END;
 
-    // Lookup for entry in commands, if found -> early return
-    if(find_entry(table, argc, argv))
+    // Lookup for entry in commands or in the top level span, if found -> early return
+    if(flat ? find_flat_entry(flat, &flat->spans[0], argc, argv) : find_entry(table, argc, argv))
+        goto KLI_DISPATCH_END;
+
+    // Lookup for entry in mounted tables, if found -> early return
+    if(find_mounted_entry(argc, argv))
+        goto KLI_DISPATCH_END;
+
+    // Lookup for a macro, if found -> early return
+    bool succeeded = true;
+    if(argc == 1 && kli_macro_call(argv[0], &succeeded)) {
+        commandFailed = !succeeded;
+        goto KLI_DISPATCH_END;
+    }
+
+    // Lookup for a unique name prefix in built-ins and commands, if found or ambiguous -> early return
+    if(flat ? find_abbreviated_flat_entry(flat, &flat->spans[0], true, argc, argv) : find_abbreviated_entry(table, true, argc, argv))
         goto KLI_DISPATCH_END;
 
     // Unknown command, display help
-    kli_print("\t'%s' - unknown command.\n\n", argv[0]);
-    help_handler();
+    if(!emit_error("unknown command", argv[0])) {
+        kli_print("\t'%s' - unknown command.\n\n", argv[0]);
+        help_handler();
+    }
+    commandFailed = true;
 KLI_DISPATCH_END:
+    if(argc)
+        kli_registry_leave();
     reset_caches();
+    return !commandFailed;
 }
 
-// Static definitions
-
 static void reset_caches(void) {
     topTable = NULL;
-    memset(command, 0, KLI_MAX_LINE_SIZE);
+    topPadding = 0;
+    command[0] = '\0';
     commandEndIndex = 0;
+    resolvingTable = NULL;
+    resolvingDepth = 0;
+    unresolvedCommand = NULL;
+}
+
+static void append_command(const char *name, size_t length) {
+
+    // Separate tokens with a space
+    if(commandEndIndex)
+        command[commandEndIndex++] = ' ';
+
+    // Copy name without relying on null termination
+    memcpy(&command[commandEndIndex], name, length);
+    commandEndIndex += length;
+    command[commandEndIndex] = '\0';
+}
+
+static void resolve_command(void) {
+
+    // Command string of a remembered command is only built when printed
+    if(!unresolvedCommand)
+        return;
+    for(int i = 0; i < unresolvedCommand->depth; i++)
+        append_command(unresolvedCommand->path[i]->name, strlen(unresolvedCommand->path[i]->name));
+    unresolvedCommand = NULL;
+}
+
+static bool find_resolved(const void *table, int argc, char **argv) {
+
+    // Cache invalidated since the last lookup of this thread -> forget all commands
+    const unsigned generation = atomic_load(&resolveGeneration);
+    if(generation != resolvedGeneration) {
+        memset(resolvedCommands, 0, sizeof(resolvedCommands));
+        resolvedGeneration = generation;
+    }
+
+    // Hash each name prefix once
+    uint32_t hashes[KLI_RESOLVE_CACHE_DEPTH + 1] = {KLI_FLAT_HASH_BASIS};
+    int depth = argc < KLI_RESOLVE_CACHE_DEPTH ? argc : KLI_RESOLVE_CACHE_DEPTH;
+    for(int i = 0; i < depth; i++) {
+        uint32_t hash = hashes[i];
+        for(const char *c = argv[i]; *c; c++)
+            hash = (hash ^ (unsigned char)*c) * KLI_FLAT_HASH_PRIME;
+        hashes[i + 1] = (hash ^ ' ') * KLI_FLAT_HASH_PRIME;
+    }
+
+    // Check remembered commands
+    for(int i = 0; i < KLI_RESOLVE_CACHE_SIZE; i++) {
+        ResolvedCommand * const resolved = &resolvedCommands[i];
+        if(resolved->table != table || resolved->depth > depth || resolved->hash != hashes[resolved->depth])
+            continue;
+
+        // Verify names, the hash only selects the candidate
+        bool verified = true;
+        for(int j = 0; j < resolved->depth && verified; j++)
+            verified = !strcmp(argv[j], resolved->path[j]->name);
+        if(!verified)
+            continue;
+
+        // Skip resolution, command string is built only if printed
+        const KliCommand * const entry = resolved->path[resolved->depth - 1];
+        resolved->used = ++resolvedClock;
+        unresolvedCommand = resolved;
+        argc -= resolved->depth;
+        argv = &argv[resolved->depth];
+
+        // User asked help, display command help
+        if(argc >= 1 && (!strcmp(argv[0], "-h") || !strcmp(argv[0], "--help"))) {
+            resolve_command();
+            print_entry(entry, resolved->padding);
+        }
+
+        // Call handler with the remembered layout
+        else
+            call_handler(entry, &resolved->layout, argc, argv, resolved->padding);
+        return true;
+    }
+
+    // Command not remembered
+    return false;
+}
+
+static void remember_resolved(const KliOptargsLayout * const layout, int padding) {
+
+    // Too deep or not resolved through a dispatch function -> not remembered
+    if(!KLI_RESOLVE_CACHE_SIZE || !resolvingTable || resolvingDepth > KLI_RESOLVE_CACHE_DEPTH)
+        return;
+
+    // Replace free or least recently used slot
+    ResolvedCommand *resolved = &resolvedCommands[0];
+    for(int i = 1; i < KLI_RESOLVE_CACHE_SIZE; i++)
+        if(resolvedCommands[i].used < resolved->used)
+            resolved = &resolvedCommands[i];
+
+    // Hash names like find_resolved does with tokens
+    uint32_t hash = KLI_FLAT_HASH_BASIS;
+    for(int i = 0; i < resolvingDepth; i++) {
+        for(const char *c = resolvingPath[i]->name; *c; c++)
+            hash = (hash ^ (unsigned char)*c) * KLI_FLAT_HASH_PRIME;
+        hash = (hash ^ ' ') * KLI_FLAT_HASH_PRIME;
+        resolved->path[i] = resolvingPath[i];
+    }
+
+    // Save resolution
+    resolved->table = resolvingTable;
+    resolved->hash = hash;
+    resolved->depth = resolvingDepth;
+    resolved->padding = padding;
+    resolved->layout = *layout;
+    resolved->used = ++resolvedClock;
 }
 
 static bool find_entry(const KliCommand table[], int argc, char **argv) {
@@ -92,85 +609,547 @@ static bool find_entry(const KliCommand table[], int argc, char **argv) {
         // Name does not match -> check next entry
         if(strcmp(argv[0], entry->name))
             continue;
-        
+
         // Name found -> next argument
-        --argc;
-        argv = &argv[1];
+        enter_entry(entry, argc - 1, &argv[1]);
+        return true;
+    }
 
-        // Save parsed name to decoded command
-        if(commandEndIndex)
-            command[commandEndIndex++] = ' ';
-        strcpy(&command[commandEndIndex], entry->name);
-        commandEndIndex += strlen(entry->name);
+    // Entry not found
+    return false;
+}
+
+static void enter_entry(const KliCommand * const entry, int argc, char **argv) {
 
-        // Check if command has subcommand or handler
-        bool haveSubcommands = entry->subcommands != NULL;
-        bool haveHandler = entry->handler != NULL;
-        bool isImplemented = haveSubcommands || haveHandler;
+    // Save parsed name to decoded command and resolution path
+    append_command(entry->name, strlen(entry->name));
+    if(resolvingDepth < KLI_RESOLVE_CACHE_DEPTH)
+        resolvingPath[resolvingDepth] = entry;
+    ++resolvingDepth;
 
-        // User asked help, display subcommand help
-        if(isImplemented && argc >= 1 && (!strcmp(argv[0], "-h") || !strcmp(argv[0], "--help")))
-            print_entry(entry);
+    // Check if command has subcommand or handler
+    bool haveSubcommands = entry->subcommands != NULL;
+    bool haveHandler = entry->handler != NULL;
+    bool isImplemented = haveSubcommands || haveHandler;
 
-        // Entry has subcommands -> find handler recusively
-        else if(haveSubcommands) {
+    // User asked help, display subcommand help
+    if(isImplemented && argc >= 1 && (!strcmp(argv[0], "-h") || !strcmp(argv[0], "--help")))
+        print_entry(entry, 0);
 
-            // Missing argument for subcommands
-            if(!argc) {
+    // Entry has subcommands -> find handler recusively
+    else if(haveSubcommands) {
+
+        // Missing argument for subcommands
+        if(!argc) {
+            if(!emit_error("expected subcommand", NULL)) {
                 kli_print("\t'%s' - expected subcommand.\n\n", command);
-                print_entry(entry);
+                print_entry(entry, 0);
             }
+            commandFailed = true;
+        }
 
-            // Subcommand not found -> print help
-            else if(!find_entry(entry->subcommands, argc, argv)) {
+        // Subcommand not found, even by a unique prefix -> print help
+        else if(!find_entry(entry->subcommands, argc, argv) && !find_abbreviated_entry(entry->subcommands, false, argc, argv)) {
+            if(!emit_error("unknown subcommand", argv[0])) {
                 kli_print("\t'%s %s' - unknown subcommand.\n\n", command, argv[0]);
-                print_entry(entry);
+                print_entry(entry, 0);
             }
+            commandFailed = true;
         }
+    }
+
+    // Entry has a handler -> remember resolution and call it with arguments
+    else if(haveHandler) {
+        KliOptargsLayout layout;
+        kli_optargs_layout(entry->options, entry->arguments, &layout);
+        remember_resolved(&layout, 0);
+        call_handler(entry, &layout, argc, argv, 0);
+    }
+
+    // No subcommands or handler -> not implemented
+    else {
+        if(!emit_error("not implemented", NULL))
+            kli_print("\t'%s' - Not implemented.\n", command);
+        commandFailed = true;
+    }
+}
 
-        // Entry has a handler -> call it with arguments
-        else if(haveHandler)
-            call_handler(entry, argc, argv);
+static bool find_mounted_entry(int argc, char **argv) {
+    int depth = 0;
+    const KliMount *mount = kli_registry_find(argc, argv, &depth);
+    if(!mount)
+        return false;
+
+    // Mount behaves like a subcommand entry named by its path, never remembered as it may be unmounted
+    const KliCommand entry = {mount->path, mount->description, mount->table, NULL, NULL, NULL, 0};
+    resolvingTable = NULL;
+    enter_entry(&entry, argc - depth, &argv[depth]);
+    return true;
+}
+
+static int search_flat_span(const KliFlatTable * const table, const KliFlatSpan * const span, const char *token) {
+
+    // Perfect hash available -> single probe
+    if(span->seed) {
+        uint32_t hash = KLI_FLAT_HASH_BASIS ^ span->seed;
+        for(const char *c = token; *c; c++)
+            hash = (hash ^ (unsigned char)*c) * KLI_FLAT_HASH_PRIME;
+        unsigned short index = table->slots[span->slots + ((hash ^ (hash >> 16)) & span->mask)];
+        if(index == KLI_FLAT_EMPTY_SLOT)
+            return -1;
+
+        // Verify the probed name
+        const KliFlatEntry * const entry = &table->entries[index];
+        bool found = !strncmp(token, &table->names[entry->name], entry->length) && !token[entry->length];
+        return found ? index : -1;
+    }
 
-        // No subcommands or handler -> not implemented
+    // Binary search over sorted siblings
+    int low = span->first;
+    int high = span->first + span->count - 1;
+    while(low <= high) {
+        int middle = low + (high - low) / 2;
+        const KliFlatEntry * const entry = &table->entries[middle];
+
+        // Compare known length, then ensure the token ends with the name
+        int comparison = strncmp(token, &table->names[entry->name], entry->length);
+        if(!comparison && token[entry->length])
+            comparison = 1;
+
+        // Name found
+        if(!comparison)
+            return middle;
+
+        // Narrow search range
+        if(comparison < 0)
+            high = middle - 1;
         else
+            low = middle + 1;
+    }
+
+    // Name not found
+    return -1;
+}
+
+static bool find_flat_entry(const KliFlatTable * const table, const KliFlatSpan * const span, int argc, char **argv) {
+
+    // Name does not match any sibling -> entry not found
+    int index = search_flat_span(table, span, argv[0]);
+    if(index < 0)
+        return false;
+
+    // Name found -> next argument
+    enter_flat_entry(table, index, argc - 1, &argv[1]);
+    return true;
+}
+
+static void enter_flat_entry(const KliFlatTable * const table, int index, int argc, char **argv) {
+    const KliFlatEntry * const entry = &table->entries[index];
+    const KliCommand * const source = table->sources[index];
+
+    // Save parsed name to decoded command and resolution path
+    append_command(&table->names[entry->name], entry->length);
+    if(resolvingDepth < KLI_RESOLVE_CACHE_DEPTH)
+        resolvingPath[resolvingDepth] = source;
+    ++resolvingDepth;
+
+    // Check if command has subcommand or handler
+    bool haveSubcommands = entry->flags & KLI_FLAT_SUBCOMMANDS;
+    bool haveHandler = entry->flags & KLI_FLAT_HANDLER;
+    bool isImplemented = haveSubcommands || haveHandler;
+
+    // User asked help, display subcommand help
+    if(isImplemented && argc >= 1 && (!strcmp(argv[0], "-h") || !strcmp(argv[0], "--help")))
+        print_entry(source, get_flat_padding(table, index));
+
+    // Entry has subcommands -> find handler recusively
+    else if(haveSubcommands) {
+
+        // Missing argument for subcommands
+        if(!argc) {
+            if(!emit_error("expected subcommand", NULL)) {
+                kli_print("\t'%s' - expected subcommand.\n\n", command);
+                print_entry(source, get_flat_padding(table, index));
+            }
+            commandFailed = true;
+        }
+
+        // Subcommand not found, even by a unique prefix -> print help
+        else if(!find_flat_entry(table, &table->spans[entry->span], argc, argv) && !find_abbreviated_flat_entry(table, &table->spans[entry->span], false, argc, argv)) {
+            if(!emit_error("unknown subcommand", argv[0])) {
+                kli_print("\t'%s %s' - unknown subcommand.\n\n", command, argv[0]);
+                print_entry(source, get_flat_padding(table, index));
+            }
+            commandFailed = true;
+        }
+    }
+
+    // Entry has a handler -> remember resolution and call it with arguments
+    else if(haveHandler) {
+        KliOptargsLayout layout;
+        kli_optargs_layout(source->options, source->arguments, &layout);
+        remember_resolved(&layout, get_flat_padding(table, index));
+        call_handler(source, &layout, argc, argv, get_flat_padding(table, index));
+    }
+
+    // No subcommands or handler -> not implemented
+    else {
+        if(!emit_error("not implemented", NULL))
             kli_print("\t'%s' - Not implemented.\n", command);
+        commandFailed = true;
+    }
+}
 
-        // Entry found
+static bool find_abbreviated_entry(const KliCommand table[], bool top, int argc, char **argv) {
+
+    // Tables not indexed only accept full names, top level names also match built-ins
+    const KliCommand * const *builtins = NULL;
+    const KliCommand * const *matches = NULL;
+    int builtinCount = top ? kli_abbrev_match(KLI_BUILTIN, argv[0], &builtins) : 0;
+    int count = kli_abbrev_match(table, argv[0], &matches);
+    builtinCount = builtinCount > 0 ? builtinCount : 0;
+    count = count > 0 ? count : 0;
+    if(!builtinCount && !count)
+        return false;
+
+    // Unique prefix -> enter entry as if its full name was given
+    if(builtinCount + count == 1) {
+        enter_entry(builtinCount ? builtins[0] : matches[0], argc - 1, &argv[1]);
         return true;
     }
 
-    // Entry not found
-    return false;
+    // Ambiguous prefix -> list candidates
+    const bool structured = kli_emit_encoding() != KLI_ENCODING_TEXT;
+    if(structured) {
+        open_error("ambiguous", argv[0]);
+        kli_emit_begin_array("candidates");
+    }
+    else
+        kli_print("\t'%s%s%s' - ambiguous, could be :\n\n", command, commandEndIndex ? " " : "", argv[0]);
+    for(int i = 0; i < builtinCount; i++)
+        print_candidate(builtins[i]->name);
+    for(int i = 0; i < count; i++)
+        print_candidate(matches[i]->name);
+    if(structured) {
+        kli_emit_end_array();
+        kli_emit_end_object();
+    }
+    else
+        kli_print("\n");
+    commandFailed = true;
+    return true;
 }
 
-static void call_handler(const KliCommand * const entry, int argc, char **argv) {
+static bool find_abbreviated_flat_entry(const KliFlatTable * const table, const KliFlatSpan * const span, bool top, int argc, char **argv) {
+
+    // Built-ins are indexed by kli_abbrev_init with any table, no index -> abbreviations disabled
+    const KliCommand * const *builtins = NULL;
+    int builtinCount = kli_abbrev_match(KLI_BUILTIN, argv[0], &builtins);
+    if(builtinCount < 0)
+        return false;
+    builtinCount = top ? builtinCount : 0;
+
+    // Siblings are sorted by name, names starting with the prefix follow its lower bound
+    const size_t length = strlen(argv[0]);
+    int low = span->first;
+    int high = span->first + span->count;
+    while(low < high) {
+        int middle = low + (high - low) / 2;
+        if(strcmp(&table->names[table->entries[middle].name], argv[0]) < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    int count = 0;
+    while(low + count < span->first + span->count && !strncmp(&table->names[table->entries[low + count].name], argv[0], length))
+        ++count;
+    if(!builtinCount && !count)
+        return false;
+
+    // Unique prefix -> enter entry as if its full name was given
+    if(builtinCount + count == 1) {
+        if(builtinCount)
+            enter_entry(builtins[0], argc - 1, &argv[1]);
+        else
+            enter_flat_entry(table, low, argc - 1, &argv[1]);
+        return true;
+    }
 
-    // Parse options and arguments
-    bool parsed = kli_optargs(entry->options, entry->arguments, argc, argv);
+    // Ambiguous prefix -> list candidates
+    const bool structured = kli_emit_encoding() != KLI_ENCODING_TEXT;
+    if(structured) {
+        open_error("ambiguous", argv[0]);
+        kli_emit_begin_array("candidates");
+    }
+    else
+        kli_print("\t'%s%s%s' - ambiguous, could be :\n\n", command, commandEndIndex ? " " : "", argv[0]);
+    for(int i = 0; i < builtinCount; i++)
+        print_candidate(builtins[i]->name);
+    for(int i = low; i < low + count; i++)
+        print_candidate(&table->names[table->entries[i].name]);
+    if(structured) {
+        kli_emit_end_array();
+        kli_emit_end_object();
+    }
+    else
+        kli_print("\n");
+    commandFailed = true;
+    return true;
+}
+
+static void call_handler(const KliCommand * const entry, const KliOptargsLayout * const layout, int argc, char **argv, int padding) {
+
+    // Cacheable handler already called with these tokens -> replay its output, unless it reads piped input or writes structured output
+    const bool cacheable = (entry->flags & KLI_COMMAND_CACHEABLE) && !pipeInput && kli_emit_encoding() == KLI_ENCODING_TEXT;
+    if(cacheable && kli_output_cache_replay(entry, argc, argv))
+        return;
+
+    // Parse options and arguments, raw handlers get the tokens as is, asynchronous handlers parse their own copy
+    bool parsed = true;
+    rawArgc = argc;
+    rawArgv = argv;
+    if(!(entry->flags & (KLI_COMMAND_RAW | KLI_COMMAND_ASYNC)))
+        parsed = kli_optargs_resolved(entry->options, entry->arguments, layout, argc, argv);
 
     // Parsing failed
-    if(!parsed)
-        print_entry(entry);
+    if(!parsed) {
+        resolve_command();
 
+        // Structured output -> error record already written by the parser
+        if(kli_emit_encoding() == KLI_ENCODING_TEXT)
+            print_entry(entry, padding);
+        commandFailed = true;
+    }
 
-    // Call handler
+    // Call handler, asynchronous handlers are started as tasks
     const char *error = NULL;
-    if(parsed)
+    if(parsed && (entry->flags & KLI_COMMAND_ASYNC)) {
+        resolve_command();
+        error = backgroundAllowed ? kli_async_start(topTable, entry, command, argc, argv) : "asynchronous commands not allowed here";
+    }
+    else if(parsed && cacheable) {
+        const KliPrintMark mark = kli_print_mark();
+        error = entry->handler();
+
+        // Keep output of a successful call, if it is still in the buffer
+        const char *output = NULL;
+        const int length = kli_print_since(&mark, &output);
+        if(!error && length >= 0)
+            kli_output_cache_store(entry, argc, argv, output, length);
+    }
+    else if(parsed)
         error = entry->handler();
 
     // Failed parsing or handling -> show help
     if(error) {
-        kli_print("\t'%s' - %s\n\n", command, error);
-        print_entry(entry);
+        resolve_command();
+        if(!emit_error(error, NULL)) {
+            kli_print("\t'%s' - %s\n\n", command, error);
+            print_entry(entry, padding);
+        }
+        commandFailed = true;
+    }
+}
+
+static const KliCommand *find_handler_entry(const KliCommand table[], int *argc, char ***argv, const char **error) {
+
+    // Walk names down to a handler entry, without printing
+    while(*argc) {
+        const KliCommand *entry = table;
+        while(entry->name && strcmp((*argv)[0], entry->name))
+            ++entry;
+
+        // Name not found -> error already set below the top level
+        if(!entry->name)
+            return NULL;
+        --*argc;
+        ++*argv;
+
+        // Handler found
+        if(!entry->subcommands && entry->handler)
+            return entry;
+
+        // Not implemented
+        if(!entry->subcommands) {
+            *error = "Not implemented.";
+            return NULL;
+        }
+
+        // Subcommand expected
+        if(!*argc) {
+            *error = "expected subcommand.";
+            return NULL;
+        }
+        table = entry->subcommands;
+        *error = "unknown subcommand.";
+    }
+    return NULL;
+}
+
+static bool validate_command(const KliCommand table[], int argc, char **argv) {
+
+    // Find first name in built-ins, then in commands
+    const KliCommand *entry = KLI_BUILTIN;
+    while(entry->name && strcmp(argv[0], entry->name))
+        ++entry;
+    if(!entry->name)
+        for(entry = table; entry->name && strcmp(argv[0], entry->name); entry++)
+            ;
+    if(entry->name)
+        return validate_entry(entry, argv, argc - 1, &argv[1]);
+
+    // Then in mounted tables, a mount behaves like a subcommand entry named by its path
+    int depth = 0;
+    int count = 0;
+    kli_registry_enter();
+    const KliMount *mount = kli_registry_find(argc, argv, &depth);
+    bool valid = false;
+    if(mount) {
+        const KliCommand mountEntry = {mount->path, mount->description, mount->table, NULL, NULL, NULL, 0};
+        valid = validate_entry(&mountEntry, argv, argc - depth, &argv[depth]);
+    }
+    else if(argc == 1 && (kli_macro_defined(argv[0]) || find_validated_macro(argv[0])))
+        valid = true;
+
+    // Then by a unique prefix in built-ins and commands
+    else if((entry = match_abbreviated(table, true, argv[0], &count)))
+        valid = validate_entry(entry, argv, argc - 1, &argv[1]);
+    else
+        kli_print(count ? "'%s' - ambiguous command." : "'%s' - unknown command.", argv[0]);
+    kli_registry_leave();
+    return valid;
+}
+
+static bool find_validated_macro(const char *name) {
+
+    // Binary search over sorted names
+    int low = 0, high = validatedMacroCount - 1;
+    while(low <= high) {
+        int middle = low + (high - low) / 2;
+        int order = strcmp(validatedMacros[middle], name);
+        if(!order)
+            return true;
+        else if(order < 0)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+    return false;
+}
+
+static bool validate_entry(const KliCommand *entry, char **names, int argc, char **argv) {
+
+    // Walk subcommands down to a handler, a help option after any name is valid
+    for(;;) {
+        if(argc >= 1 && (entry->subcommands || entry->handler) && (!strcmp(argv[0], "-h") || !strcmp(argv[0], "--help")))
+            return true;
+
+        // Handler reached -> check its options and arguments, raw handlers parse their own tokens
+        if(!entry->subcommands) {
+            if(entry->handler)
+                return (entry->flags & KLI_COMMAND_RAW) || validate_optargs(entry, argc, argv);
+            print_names(names, argv);
+            kli_print(" - Not implemented.");
+            return false;
+        }
+
+        // Find subcommand
+        const KliCommand *subcommand = entry->subcommands;
+        while(argc && subcommand->name && strcmp(argv[0], subcommand->name))
+            ++subcommand;
+        int count = 0;
+        if(argc && !subcommand->name && !(subcommand = match_abbreviated(entry->subcommands, false, argv[0], &count)) && count) {
+            print_names(names, &argv[1]);
+            kli_print(" - ambiguous subcommand.");
+            return false;
+        }
+        if(!argc || !subcommand || !subcommand->name) {
+            print_names(names, argc ? &argv[1] : argv);
+            kli_print(argc ? " - unknown subcommand." : " - expected subcommand.");
+            return false;
+        }
+        entry = subcommand;
+        --argc;
+        ++argv;
     }
 }
 
+static bool validate_optargs(const KliCommand * const entry, int argc, char **argv) {
+
+    // Parse in a local context, parse errors are printed in the held error printer
+    KliOptargs optargs;
+    KliOptargs *previous = kli_optargs_bind(&optargs);
+    bool valid = kli_optargs(entry->options, entry->arguments, argc, argv);
+    kli_optargs_bind(previous);
+
+    // Typed values must parse as handlers would parse them
+    for(int opti = 0; valid && opti < optargs.options; opti++)
+        for(int i = 0; valid && optargs.optFound[opti] && i < optargs.optvLength[opti]; i++)
+            valid = validate_value(entry->options[opti].type, optargs.optv[optargs.optvOffset[opti] + i]);
+    for(int argi = 0; valid && argi < optargs.arguments; argi++)
+        valid = !optargs.argFound[argi] || validate_value(entry->arguments[argi].type, optargs.argv[argi]);
+    return valid;
+}
+
+static bool validate_value(unsigned char type, const char *value) {
+    long integer = 0;
+    float real = 0;
+    if(type == KLI_TYPE_INT && !kli_parse_long(value, &integer)) {
+        kli_print("'%s' - expected integer value.", value);
+        return false;
+    }
+    if(type == KLI_TYPE_FLOAT && !kli_parse_float(value, &real)) {
+        kli_print("'%s' - expected floating point value.", value);
+        return false;
+    }
+    return true;
+}
+
+static const KliCommand *match_abbreviated(const KliCommand table[], bool top, const char *prefix, int *count) {
+    const KliCommand * const *builtins = NULL;
+    const KliCommand * const *matches = NULL;
+    int builtinCount = top ? kli_abbrev_match(KLI_BUILTIN, prefix, &builtins) : 0;
+    int tableCount = kli_abbrev_match(table, prefix, &matches);
+    builtinCount = builtinCount > 0 ? builtinCount : 0;
+    tableCount = tableCount > 0 ? tableCount : 0;
+
+    // Only a unique prefix matches
+    *count = builtinCount + tableCount;
+    if(*count != 1)
+        return NULL;
+    return builtinCount ? builtins[0] : matches[0];
+}
+
+static void print_names(char **first, char **last) {
+    kli_print("'");
+    for(char **name = first; name < last; name++)
+        kli_print(name == first ? "%s" : " %s", *name);
+    kli_print("'");
+}
+
+static void print_candidate(const char *name) {
+    if(kli_emit_encoding() != KLI_ENCODING_TEXT)
+        kli_emit_str(NULL, name);
+    else
+        kli_print("\t\t%s%s%s\n", command, commandEndIndex ? " " : "", name);
+}
+
+static int get_flat_padding(const KliFlatTable * const table, int index) {
+    const KliFlatEntry * const entry = &table->entries[index];
+
+    // Entry has subcommands -> padding of the children span
+    if(entry->flags & KLI_FLAT_SUBCOMMANDS)
+        return table->spans[entry->span].padding;
+
+    // Entry has a handler -> padding of the options and arguments, if precomputed
+    return table->paddings ? table->paddings[index] : 0;
+}
+
 static int get_optargs_padding(const KliCommand * const entry) {
 
     // Initialize alignement padding
     int padding = 0;
-    for(const KliOption *option = entry->options; option && option->longName; option++) {
+    for(const KliOption *option = entry->options; option && (option->shortName || option->longName); option++) {
         
         // Add single dash length with short option length
         int length = 0;
@@ -289,20 +1268,51 @@ static void print_table(const KliCommand table[], int padding) {
         }
 
         // Print concatenated fields with padded description
-        kli_print("%-*s - %s\n", padding, buffer, entry->description);
+        print_help_line(padding, buffer, entry->description, commandEndIndex ? " " : "", entry->name);
     }
 }
 
-static void print_entry(const KliCommand * const entry) {
+static void print_mounts(int padding) {
+
+    // Print mounted tables like subcommand entries
+    for(int i = 0; i < KLI_REGISTRY_SIZE; i++) {
+        const KliMount *mount = kli_registry_at(i);
+        if(!mount)
+            continue;
+        char buffer[KLI_MAX_PADDING] = {0};
+        snprintf(buffer, KLI_MAX_PADDING, "%s %s", mount->path, SUBCOMMANDS_TAG);
+        kli_print("\t\t");
+        print_help_line(padding, buffer, mount->description, NULL, NULL);
+    }
+}
+
+static int get_mounts_padding(void) {
+    int padding = 0;
+    for(int i = 0; i < KLI_REGISTRY_SIZE; i++) {
+        const KliMount *mount = kli_registry_at(i);
+        int length = mount ? (int)(strlen(mount->path) + sizeof(SUBCOMMANDS_TAG)) : 0;
+        padding = length > padding ? length : padding;
+    }
+    return padding;
+}
+
+static void print_entry(const KliCommand * const entry, int padding) {
+
+    // Structured output -> help record
+    if(kli_emit_encoding() != KLI_ENCODING_TEXT) {
+        emit_entry(entry);
+        return;
+    }
 
     // Print command name and description
     kli_print("\t%s\n\n", COMMAND_BEACON);
-    kli_print("\t\t'%s' - %s\n", command, entry->description);
+    kli_print("\t\t'%s'", command);
+    print_help_line(0, "", entry->description, "", "");
 
     // Entry has subcommands -> print subcommands
     if(entry->subcommands) {
         kli_print("\n\t%s\n\n", SUBCOMMANDS_BEACON);
-        print_table(entry->subcommands, get_table_padding(entry->subcommands));
+        print_table(entry->subcommands, padding ? padding : get_table_padding(entry->subcommands));
         return;
     }
 
@@ -321,8 +1331,9 @@ static void print_entry(const KliCommand * const entry) {
         kli_print(" %s", ARGUMENTS_TAG);
     kli_print("\n");
 
-    // Find optargs padding
-    int padding = get_optargs_padding(entry);
+    // Find optargs padding, if not precomputed
+    if(!padding)
+        padding = get_optargs_padding(entry);
 
     // Entry has options -> print options
     if(entry->options) {
@@ -358,26 +1369,161 @@ static void print_entry(const KliCommand * const entry) {
             }
                 
             // Print option fields with concatenated description
-            kli_print("%-*s - %s\n", padding, buffer, option->description);
+            const char shortName[2] = {option->shortName, '\0'};
+            print_help_line(padding, buffer, option->description, option->longName ? " --" : " -", option->longName ? option->longName : shortName);
         }
     }
 
     // Entry has arguments -> print arguments
     if(entry->arguments) {
         kli_print("\n\t%s\n\n", ARGUMENTS_BEACON);
-        for(const KliArgument *argument = entry->arguments; argument->name; argument++)
-            kli_print("\t\t%-*s - %s\n", padding, argument->name, argument->description);
+        for(const KliArgument *argument = entry->arguments; argument->name; argument++) {
+            kli_print("\t\t");
+            print_help_line(padding, argument->name, argument->description, " ", argument->name);
+        }
+    }
+}
+
+static void print_help_line(int padding, const char *text, const char *description, const char *separator, const char *name) {
+
+    // Stripped help -> names only
+    if(KLI_HELP_MODE == KLI_HELP_STRIPPED) {
+        kli_print("%s\n", text);
+        return;
     }
+
+    // Description from the help blob, else from the entry, runtime mount descriptions have no key
+    kli_print("%-*s - ", padding, text);
+    if(KLI_HELP_MODE != KLI_HELP_SECTION || !name || !kli_help_print(kli_help_key(commandEndIndex ? command : "", separator, name)))
+        kli_print("%s", description ? description : "");
+    kli_print("\n");
+}
+
+static bool emit_error(const char *message, const char *name) {
+
+    // Text output -> printed by the caller, followed by help
+    if(kli_emit_encoding() == KLI_ENCODING_TEXT)
+        return false;
+    open_error(message, name);
+    kli_emit_end_object();
+    return true;
+}
+
+static void open_error(const char *message, const char *name) {
+    kli_emit_begin_object(NULL);
+    kli_emit_str("error", message);
+    if(commandEndIndex)
+        kli_emit_str("command", command);
+    if(name)
+        kli_emit_str("name", name);
+}
+
+static void emit_table(const KliCommand table[]) {
+    for(const KliCommand *entry = table; entry->name; entry++) {
+        kli_emit_begin_object(NULL);
+        kli_emit_str("name", entry->name);
+        emit_description(entry->description, commandEndIndex ? " " : "", entry->name);
+        kli_emit_bool("subcommands", entry->subcommands != NULL);
+        kli_emit_end_object();
+    }
+}
+
+static void emit_mounts(void) {
+    for(int i = 0; i < KLI_REGISTRY_SIZE; i++) {
+        const KliMount *mount = kli_registry_at(i);
+        if(!mount)
+            continue;
+        kli_emit_begin_object(NULL);
+        kli_emit_str("name", mount->path);
+        emit_description(mount->description, NULL, NULL);
+        kli_emit_bool("subcommands", true);
+        kli_emit_end_object();
+    }
+}
+
+static void emit_entry(const KliCommand * const entry) {
+    kli_emit_begin_object(NULL);
+    kli_emit_str("command", command);
+    emit_description(entry->description, "", "");
+
+    // Entry has subcommands -> list them
+    if(entry->subcommands) {
+        kli_emit_begin_array("subcommands");
+        emit_table(entry->subcommands);
+        kli_emit_end_array();
+    }
+
+    // Entry has no handler -> not implemented
+    else if(!entry->handler)
+        kli_emit_bool("implemented", false);
+
+    // Entry has a handler -> list options and arguments
+    else {
+        kli_emit_begin_array("options");
+        for(const KliOption *option = entry->options; option && (option->shortName || option->longName); option++) {
+            const char shortName[2] = {option->shortName, '\0'};
+            kli_emit_begin_object(NULL);
+            if(option->shortName)
+                kli_emit_str("short", shortName);
+            if(option->longName)
+                kli_emit_str("long", option->longName);
+            kli_emit_u32("values", option->argc);
+            emit_description(option->description, option->longName ? " --" : " -", option->longName ? option->longName : shortName);
+            kli_emit_end_object();
+        }
+        kli_emit_end_array();
+        kli_emit_begin_array("arguments");
+        for(const KliArgument *argument = entry->arguments; argument && argument->name; argument++) {
+            kli_emit_begin_object(NULL);
+            kli_emit_str("name", argument->name);
+            emit_description(argument->description, " ", argument->name);
+            kli_emit_end_object();
+        }
+        kli_emit_end_array();
+    }
+    kli_emit_end_object();
+}
+
+static void emit_description(const char *description, const char *separator, const char *name) {
+
+    // Stripped help -> names only
+    if(KLI_HELP_MODE == KLI_HELP_STRIPPED)
+        return;
+
+    // Description from the help blob, else from the entry, like print_help_line
+    char buffer[KLI_MAX_LINE_SIZE];
+    if(KLI_HELP_MODE == KLI_HELP_SECTION && name && kli_help_read(kli_help_key(commandEndIndex ? command : "", separator, name), buffer, sizeof(buffer)))
+        kli_emit_str("description", buffer);
+    else
+        kli_emit_str("description", description ? description : "");
 }
 
 static const char *help_handler(void) {
     const int BUILTIN_PADDING = get_table_padding(KLI_BUILTIN);
-    const int TOP_TABLE_PADDING = get_table_padding(topTable);
-    const int MAX_PADDING = TOP_TABLE_PADDING > BUILTIN_PADDING ? TOP_TABLE_PADDING : BUILTIN_PADDING;
-    kli_print("\t%s\n\n", COMMANDS_BEACON);
+    const int TOP_TABLE_PADDING = topPadding ? topPadding : get_table_padding(topTable);
+    kli_registry_enter();
+    const int MOUNTS_PADDING = get_mounts_padding();
+    int maxPadding = TOP_TABLE_PADDING > BUILTIN_PADDING ? TOP_TABLE_PADDING : BUILTIN_PADDING;
+    maxPadding = MOUNTS_PADDING > maxPadding ? MOUNTS_PADDING : maxPadding;
     commandEndIndex = 0;
-    print_table(KLI_BUILTIN, MAX_PADDING);
-    print_table(topTable, MAX_PADDING);
+
+    // Structured output -> single record listing commands
+    if(kli_emit_encoding() != KLI_ENCODING_TEXT) {
+        kli_emit_begin_object(NULL);
+        kli_emit_begin_array("commands");
+        emit_table(KLI_BUILTIN);
+        emit_table(topTable);
+        emit_mounts();
+        kli_emit_end_array();
+        kli_emit_end_object();
+        kli_registry_leave();
+        return NULL;
+    }
+    kli_print("\t%s\n\n", COMMANDS_BEACON);
+    print_table(KLI_BUILTIN, maxPadding);
+    print_table(topTable, maxPadding);
+    print_mounts(maxPadding);
+    kli_registry_leave();
     return NULL;
 }
 
@@ -385,3 +1531,118 @@ static const char *clear_handler(void) {
     kli_print("\033[2J\033[H");
     return NULL;
 }
+
+static const char *every_handler(void) {
+    char **argv = NULL;
+    int argc = kli_get_raw(&argv);
+    if(!backgroundAllowed)
+        return "scheduled commands not allowed here";
+
+    // No argument -> list jobs
+    if(!argc) {
+        kli_schedule_list();
+        return NULL;
+    }
+
+    // Stop all jobs, only when asked by name
+    if(!strcmp(argv[0], "stop")) {
+        if(argc != 2)
+            return "expected job to stop";
+        if(!strcmp(argv[1], "all"))
+            return kli_unschedule(-1) ? NULL : "no such job";
+
+        // Stop a job, identifier checked before narrowing it
+        long id = -1;
+        if(!kli_parse_long(argv[1], &id) || id < 0 || id >= KLI_MAX_JOBS)
+            return "expected job to stop";
+        return kli_unschedule((int)id) ? NULL : "no such job";
+    }
+
+    // Schedule command
+    long period = 0;
+    if(!kli_parse_long(argv[0], &period) || period <= 0)
+        return "expected a positive period in milliseconds";
+    if(argc < 2)
+        return "expected command";
+    int id = kli_schedule(topTable, argc - 1, &argv[1], period, false);
+    if(id < 0)
+        return "command not scheduled";
+    if(kli_emit_encoding() != KLI_ENCODING_TEXT) {
+        kli_emit_begin_object(NULL);
+        kli_emit_u32("job", id);
+        kli_emit_u32("period", period);
+        kli_emit_bool("watch", false);
+        kli_emit_end_object();
+    }
+    else
+        kli_print("\tJob %d - every %ld ms\n", id, period);
+    return NULL;
+}
+
+static const char *watch_handler(void) {
+    char **argv = NULL;
+    int argc = kli_get_raw(&argv);
+    if(!backgroundAllowed)
+        return "scheduled commands not allowed here";
+
+    // Schedule command with screen clearing
+    if(!argc)
+        return "expected command";
+    int id = kli_schedule(topTable, argc, argv, KLI_WATCH_PERIOD_MS, true);
+    if(id < 0)
+        return "command not scheduled";
+    if(kli_emit_encoding() != KLI_ENCODING_TEXT) {
+        kli_emit_begin_object(NULL);
+        kli_emit_u32("job", id);
+        kli_emit_u32("period", KLI_WATCH_PERIOD_MS);
+        kli_emit_bool("watch", true);
+        kli_emit_end_object();
+    }
+    else
+        kli_print("\tJob %d - watch every %d ms\n", id, KLI_WATCH_PERIOD_MS);
+    return NULL;
+}
+
+static const char *macro_handler(void) {
+    char **argv = NULL;
+    int argc = kli_get_raw(&argv);
+
+    // No argument -> list macros
+    if(!argc) {
+        kli_macro_list();
+        return NULL;
+    }
+
+    // Name only -> remove macro
+    if(argc == 1)
+        return kli_macro_remove(argv[0]) ? NULL : "no such macro";
+
+    // Resolve and store commands
+    if(!kli_macro_define(topTable, argv[0], argc - 1, &argv[1]))
+        return "invalid macro";
+    if(kli_emit_encoding() != KLI_ENCODING_TEXT)
+        kli_emit_str("macro", argv[0]);
+    else
+        kli_print("\tMacro '%s' - stored\n", argv[0]);
+    return NULL;
+}
+
+static const char *encoding_handler(void) {
+    char *name = NULL;
+
+    // No argument -> show current encoding
+    if(!kli_get_arg(0, &name)) {
+        const unsigned char encoding = kli_emit_encoding();
+        kli_emit_str("encoding", encoding < sizeof(ENCODINGS) / sizeof(ENCODINGS[0]) ? ENCODINGS[encoding] : "");
+        return NULL;
+    }
+
+    // Select encoding of the bound printer, kept by the session
+    for(unsigned char i = 0; i < sizeof(ENCODINGS) / sizeof(ENCODINGS[0]); i++) {
+        if(!strcmp(name, ENCODINGS[i])) {
+            kli_emit_select(i);
+            return NULL;
+        }
+    }
+    return "expected 'text', 'json' or 'cbor'";
+}
@@ -0,0 +1,399 @@
+/**
+ * @file kli_emit.c
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI structured output implementation, values appended to the print buffer with kli_put.
+ */
+
+// Includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "kli_emit.h"
+#include "kli_config.h"
+#include "kli_print.h"
+
+// Definitions
+
+#define CBOR_UNSIGNED                   0       // CBOR major type of unsigned integers.
+#define CBOR_NEGATIVE                   1       // CBOR major type of negative integers.
+#define CBOR_TEXT                       3       // CBOR major type of text strings.
+#define CBOR_MAP                        5       // CBOR major type of maps.
+#define CBOR_FALSE                      0xF4    // CBOR false.
+#define CBOR_TRUE                       0xF5    // CBOR true.
+#define CBOR_FLOAT                      0xFA    // CBOR single precision float header.
+#define CBOR_ARRAY_START                0x9F    // CBOR indefinite length array.
+#define CBOR_MAP_START                  0xBF    // CBOR indefinite length map.
+#define CBOR_BREAK                      0xFF    // CBOR end of an indefinite length item.
+
+// Static variables
+
+static KLI_THREAD_LOCAL int depth                           = 0;
+static KLI_THREAD_LOCAL bool members[KLI_EMIT_DEPTH]        = {false};
+static KLI_THREAD_LOCAL bool arrays[KLI_EMIT_DEPTH]         = {false};
+static KLI_THREAD_LOCAL bool wrapped                        = false;
+
+// Static prototypes
+
+/**
+ * @brief Write what precedes a value : separator, key, indentation.
+ * @param key Member name, ignored inside arrays.
+ * @param container Value is an object or an array.
+ * @return True if the value must be written, false if it is nested too deep.
+ */
+static bool begin_value(const char *key, bool container);
+
+/**
+ * @brief Write what follows a scalar value, ending the record at top level.
+ */
+static void end_scalar(void);
+
+/**
+ * @brief Open an object or an array.
+ * @param key Member name.
+ * @param array Container is an array.
+ */
+static void begin_container(const char *key, bool array);
+
+/**
+ * @brief Close the last opened object or array.
+ */
+static void end_container(void);
+
+/**
+ * @brief Write a string as is, or quoted and escaped for JSON.
+ * @param string Null terminated string.
+ */
+static void put_string(const char *string);
+
+/**
+ * @brief Write an unsigned integer in base 10.
+ * @param value Value.
+ */
+static void put_decimal(unsigned long long value);
+
+/**
+ * @brief Write a floating point value in base 10, with KLI_EMIT_DECIMALS decimals.
+ * @param value Finite value.
+ */
+static void put_float(float value);
+
+/**
+ * @brief Write a CBOR item header.
+ * @param major Major type.
+ * @param value Argument of the header, e.g. the length of a string.
+ */
+static void put_cbor_head(unsigned char major, uint32_t value);
+
+/**
+ * @brief Write a single byte.
+ * @param byte Byte.
+ */
+static inline void put_byte(unsigned char byte);
+
+// Implementations
+
+unsigned char kli_emit_select(unsigned char encoding) {
+    KliPrinter * const printer = kli_print_bound();
+    const unsigned char previous = printer->encoding;
+    printer->encoding = encoding;
+    depth = 0;
+    wrapped = false;
+    return previous;
+}
+
+unsigned char kli_emit_encoding(void) {
+    return kli_print_bound()->encoding;
+}
+
+void kli_emit_begin_object(const char *key) {
+    begin_container(key, false);
+}
+
+void kli_emit_end_object(void) {
+    end_container();
+}
+
+void kli_emit_begin_array(const char *key) {
+    begin_container(key, true);
+}
+
+void kli_emit_end_array(void) {
+    end_container();
+}
+
+void kli_emit_str(const char *key, const char *value) {
+    if(!begin_value(key, false))
+        return;
+    if(kli_emit_encoding() == KLI_ENCODING_CBOR)
+        put_cbor_head(CBOR_TEXT, strlen(value));
+    put_string(value);
+    end_scalar();
+}
+
+void kli_emit_u32(const char *key, uint32_t value) {
+    if(!begin_value(key, false))
+        return;
+    if(kli_emit_encoding() == KLI_ENCODING_CBOR)
+        put_cbor_head(CBOR_UNSIGNED, value);
+    else
+        put_decimal(value);
+    end_scalar();
+}
+
+void kli_emit_i32(const char *key, int32_t value) {
+    if(!begin_value(key, false))
+        return;
+
+    // CBOR negative integers hold -1 - value
+    if(kli_emit_encoding() == KLI_ENCODING_CBOR)
+        put_cbor_head(value < 0 ? CBOR_NEGATIVE : CBOR_UNSIGNED, value < 0 ? (uint32_t)(-1 - value) : (uint32_t)value);
+    else {
+        if(value < 0)
+            put_byte('-');
+        put_decimal(value < 0 ? 0u - (uint32_t)value : (uint32_t)value);
+    }
+    end_scalar();
+}
+
+void kli_emit_float(const char *key, float value) {
+    if(!begin_value(key, false))
+        return;
+    const unsigned char encoding = kli_emit_encoding();
+
+    // CBOR single precision, big endian
+    if(encoding == KLI_ENCODING_CBOR) {
+        uint32_t bits = 0;
+        memcpy(&bits, &value, sizeof(bits));
+        put_byte(CBOR_FLOAT);
+        for(int shift = 24; shift >= 0; shift -= 8)
+            put_byte(bits >> shift);
+    }
+
+    // Not a number and infinities have no JSON representation
+    else if(value != value || value - value != 0.0f) {
+        if(encoding == KLI_ENCODING_JSON)
+            kli_put("null", 4);
+        else if(value != value)
+            kli_put("nan", 3);
+        else
+            kli_put(value < 0 ? "-inf" : "inf", value < 0 ? 4 : 3);
+    }
+    else
+        put_float(value);
+    end_scalar();
+}
+
+void kli_emit_bool(const char *key, bool value) {
+    if(!begin_value(key, false))
+        return;
+    if(kli_emit_encoding() == KLI_ENCODING_CBOR)
+        put_byte(value ? CBOR_TRUE : CBOR_FALSE);
+    else
+        kli_put(value ? "true" : "false", value ? 4 : 5);
+    end_scalar();
+}
+
+bool kli_emit_error(const char *message, const char *name) {
+    if(kli_emit_encoding() == KLI_ENCODING_TEXT)
+        return false;
+    kli_emit_begin_object(NULL);
+    kli_emit_str("error", message);
+    if(name)
+        kli_emit_str("name", name);
+    kli_emit_end_object();
+    return true;
+}
+
+// Static definitions
+
+static bool begin_value(const char *key, bool container) {
+    if(depth >= KLI_EMIT_DEPTH)
+        return false;
+    const unsigned char encoding = kli_emit_encoding();
+    const bool keyed = key && !(depth && arrays[depth - 1]);
+
+    // JSON -> comma between members, keyed top level values are wrapped in an object
+    if(encoding == KLI_ENCODING_JSON) {
+        if(depth && members[depth - 1])
+            put_byte(',');
+        if(!depth && keyed) {
+            put_byte('{');
+            wrapped = true;
+        }
+        if(keyed) {
+            put_string(key);
+            put_byte(':');
+        }
+    }
+
+    // CBOR -> key item, keyed top level values are wrapped in a map of one pair
+    else if(encoding == KLI_ENCODING_CBOR) {
+        if(!depth && keyed)
+            put_cbor_head(CBOR_MAP, 1);
+        if(keyed) {
+            put_cbor_head(CBOR_TEXT, strlen(key));
+            put_string(key);
+        }
+    }
+
+    // Text -> indented key, containers without key only indent their members
+    else if(keyed || !container) {
+        for(int i = 0; i < (depth ? depth : 1); i++)
+            put_byte('\t');
+        if(keyed) {
+            put_string(key);
+            kli_put(container ? "\n" : " : ", container ? 1 : 3);
+        }
+    }
+
+    // Value is a member of the enclosing container
+    if(depth)
+        members[depth - 1] = true;
+    return true;
+}
+
+static void end_scalar(void) {
+    const unsigned char encoding = kli_emit_encoding();
+    if(encoding == KLI_ENCODING_TEXT)
+        put_byte('\n');
+
+    // JSON top level value -> end of line
+    else if(encoding == KLI_ENCODING_JSON && !depth) {
+        if(wrapped)
+            put_byte('}');
+        put_byte('\n');
+        wrapped = false;
+    }
+}
+
+static void begin_container(const char *key, bool array) {
+
+    // Too deep -> counted to match its end, but dropped
+    if(!begin_value(key, true)) {
+        ++depth;
+        return;
+    }
+    const unsigned char encoding = kli_emit_encoding();
+    if(encoding == KLI_ENCODING_JSON)
+        put_byte(array ? '[' : '{');
+    else if(encoding == KLI_ENCODING_CBOR)
+        put_byte(array ? CBOR_ARRAY_START : CBOR_MAP_START);
+    members[depth] = false;
+    arrays[depth] = array;
+    ++depth;
+}
+
+static void end_container(void) {
+    if(!depth || --depth >= KLI_EMIT_DEPTH)
+        return;
+    const unsigned char encoding = kli_emit_encoding();
+    if(encoding == KLI_ENCODING_JSON)
+        put_byte(arrays[depth] ? ']' : '}');
+    else if(encoding == KLI_ENCODING_CBOR)
+        put_byte(CBOR_BREAK);
+    if(depth)
+        return;
+
+    // Top level container -> end of record
+    if(encoding == KLI_ENCODING_JSON) {
+        if(wrapped)
+            put_byte('}');
+        put_byte('\n');
+        wrapped = false;
+    }
+    else if(encoding == KLI_ENCODING_TEXT)
+        put_byte('\n');
+}
+
+static void put_string(const char *string) {
+    if(kli_emit_encoding() != KLI_ENCODING_JSON) {
+        kli_put(string, strlen(string));
+        return;
+    }
+
+    // Quote, and escape quotes, backslashes and control characters, plain runs are written at once
+    static const char HEX[] = "0123456789abcdef";
+    put_byte('"');
+    for(const char *run = string;;) {
+        const char *c = run;
+        while(*c && *c != '"' && *c != '\\' && (unsigned char)*c >= 0x20)
+            ++c;
+        kli_put(run, c - run);
+        if(!*c)
+            break;
+        if(*c == '"' || *c == '\\') {
+            const char escape[2] = {'\\', *c};
+            kli_put(escape, 2);
+        }
+        else {
+            const char escape[6] = {'\\', 'u', '0', '0', HEX[(unsigned char)*c >> 4], HEX[*c & 0x0F]};
+            kli_put(escape, 6);
+        }
+        run = c + 1;
+    }
+    put_byte('"');
+}
+
+static void put_decimal(unsigned long long value) {
+    char digits[20];
+    int first = sizeof(digits);
+    do {
+        digits[--first] = '0' + value % 10;
+        value /= 10;
+    } while(value);
+    kli_put(&digits[first], sizeof(digits) - first);
+}
+
+static void put_float(float value) {
+    double magnitude = value < 0 ? -(double)value : value;
+    if(value < 0)
+        put_byte('-');
+
+    // Large values -> scientific notation, so the fixed point part fits
+    int exponent = 0;
+    while(magnitude >= 1e15) {
+        magnitude /= 10;
+        ++exponent;
+    }
+
+    // Round to the decimals once, then split integer and fractional digits
+    unsigned long long scale = 1;
+    for(int i = 0; i < KLI_EMIT_DECIMALS; i++)
+        scale *= 10;
+    const unsigned long long fixed = (unsigned long long)(magnitude * scale + 0.5);
+    put_decimal(fixed / scale);
+    if(KLI_EMIT_DECIMALS > 0) {
+        char fraction[KLI_EMIT_DECIMALS > 0 ? KLI_EMIT_DECIMALS + 1 : 1];
+        unsigned long long rest = fixed % scale;
+        fraction[0] = '.';
+        for(int i = KLI_EMIT_DECIMALS; i > 0; i--) {
+            fraction[i] = '0' + rest % 10;
+            rest /= 10;
+        }
+        kli_put(fraction, sizeof(fraction));
+    }
+    if(exponent) {
+        put_byte('e');
+        put_decimal(exponent);
+    }
+}
+
+static void put_cbor_head(unsigned char major, uint32_t value) {
+    major <<= 5;
+
+    // Argument in the initial byte, or in the 1, 2 or 4 following bytes
+    if(value < 24) {
+        put_byte(major | value);
+        return;
+    }
+    int bytes = value <= 0xFF ? 1 : value <= 0xFFFF ? 2 : 4;
+    put_byte(major | (bytes == 1 ? 24 : bytes == 2 ? 25 : 26));
+    for(int shift = (bytes - 1) * 8; shift >= 0; shift -= 8)
+        put_byte(value >> shift);
+}
+
+static inline void put_byte(unsigned char byte) {
+    kli_put((const char *)&byte, 1);
+}
@@ -0,0 +1,137 @@
+/**
+ * @file kli_help.c
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI help implementation.
+ */
+
+// Includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "kli_help.h"
+#include "kli_config.h"
+#include "kli_dispatch.h"
+#include "kli_print.h"
+
+// Static prototypes
+
+/**
+ * @brief Find the description of a key.
+ * @param key Help key.
+ * @return Index of the key, -1 if not found.
+ */
+static int find_key(uint32_t key);
+
+/**
+ * @brief Expand a description in a buffer, either printing it by chunks or truncating it to the buffer.
+ * @param index Index of the key.
+ * @param buffer Chunk or description buffer.
+ * @param size Buffer size.
+ * @param print Print the buffer through kli_print each time it is full, and at the end.
+ * @return Length of the expanded description left in the buffer.
+ */
+static int expand(int index, char *buffer, int size, bool print);
+
+/**
+ * @brief Hash a string after previous ones.
+ * @param hash Hash of the previous strings.
+ * @param string String to add.
+ * @return Hash including the string.
+ */
+static inline uint32_t hash_string(uint32_t hash, const char *string);
+
+// Implementations
+
+uint32_t kli_help_key(const char *path, const char *separator, const char *name) {
+    return hash_string(hash_string(hash_string(KLI_FLAT_HASH_BASIS, path), separator), name);
+}
+
+bool kli_help_print(uint32_t key) {
+    const int index = find_key(key);
+    if(index < 0)
+        return false;
+
+    // Print by chunks, descriptions have no length limit
+    char chunk[32];
+    expand(index, chunk, sizeof(chunk), true);
+    return true;
+}
+
+bool kli_help_read(uint32_t key, char *buffer, int size) {
+    const int index = find_key(key);
+    if(index < 0 || size < 1)
+        return false;
+    buffer[expand(index, buffer, size - 1, false)] = '\0';
+    return true;
+}
+
+// Static definitions
+
+static int find_key(uint32_t key) {
+#if KLI_HELP_MODE == KLI_HELP_SECTION
+
+    // Binary search over sorted keys
+    int low = 0, high = KLI_HELP.count - 1;
+    while(low <= high) {
+        int middle = (low + high) / 2;
+        if(KLI_HELP.keys[middle] == key)
+            return middle;
+        else if(KLI_HELP.keys[middle] < key)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+#else
+    (void)key;
+#endif
+    return -1;
+}
+
+static int expand(int index, char *buffer, int size, bool print) {
+    int length = 0;
+#if KLI_HELP_MODE == KLI_HELP_SECTION
+
+    // Expand codes depth first, with plain bytes going to the buffer
+    unsigned char stack[KLI_HELP_STACK_SIZE];
+    for(const unsigned char *byte = &KLI_HELP.data[KLI_HELP.offsets[index]]; *byte; byte++) {
+        int depth = 0;
+        stack[depth++] = *byte;
+        while(depth) {
+            const unsigned char c = stack[--depth];
+
+            // Code -> push its pair, second byte first
+            if(KLI_HELP.pairs && c >= KLI_HELP.first) {
+                stack[depth++] = KLI_HELP.pairs[c - KLI_HELP.first][1];
+                stack[depth++] = KLI_HELP.pairs[c - KLI_HELP.first][0];
+                continue;
+            }
+
+            // Full buffer -> print it, or truncate
+            if(length == size && !print)
+                return length;
+            if(length == size) {
+                kli_print("%.*s", length, buffer);
+                length = 0;
+            }
+            buffer[length++] = (char)c;
+        }
+    }
+    if(print && length) {
+        kli_print("%.*s", length, buffer);
+        length = 0;
+    }
+#else
+    (void)index;
+    (void)buffer;
+    (void)size;
+    (void)print;
+#endif
+    return length;
+}
+
+static inline uint32_t hash_string(uint32_t hash, const char *string) {
+    for(const char *c = string; *c; c++)
+        hash = (hash ^ (unsigned char)*c) * KLI_FLAT_HASH_PRIME;
+    return hash;
+}
@@ -0,0 +1,519 @@
+/**
+ * @file kli_input.c
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI interactive input implementation.
+ */
+
+// Includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "kli_input.h"
+#include "kli_async.h"
+#include "kli_config.h"
+#include "kli_parse.h"
+#include "kli_print.h"
+
+// Static definitions
+
+#define NODE_WORD                   0x01    // A command or option name ends at this node.
+#define NODE_HANDLER                0x02    // A handler name ends at this node, its options follow a space.
+#define ESCAPE_NONE                 0       // No escape sequence.
+#define ESCAPE_START                1       // Escape received.
+#define ESCAPE_SEQUENCE             2       // Escape and '[' or 'O' received, waiting for the final byte.
+#define KEY_INTERRUPT               0x03    // Ctrl-C.
+#define KEY_BACKSPACE               0x08    // Ctrl-H.
+#define KEY_TAB                     0x09
+#define KEY_CLEAR                   0x15    // Ctrl-U.
+#define KEY_ESCAPE                  0x1B
+#define KEY_DELETE                  0x7F
+
+// Static structures
+
+/**
+ * @brief Completion trie node, children are linked as siblings sorted by character.
+ */
+typedef struct TrieNode {
+
+    // Character leading to this node.
+    char c;
+
+    // Node flags, see NODE_WORD.
+    unsigned char flags;
+
+    // First child index, 0 if none as the root is never a child.
+    uint16_t child;
+
+    // Next sibling index, 0 if none.
+    uint16_t sibling;
+
+} TrieNode;
+
+// Static variables
+
+static KLI_THREAD_LOCAL TrieNode nodes[KLI_TRIE_NODES > 1 ? KLI_TRIE_NODES : 2] = {0};
+static KLI_THREAD_LOCAL int nodeCount = 0;
+static KLI_THREAD_LOCAL const KliCommand *trieTable = NULL;
+
+// Static prototypes
+
+/**
+ * @brief Build the completion trie of a top level table, once per table.
+ * @param table Top level table containing subtables and handlers.
+ */
+static void build_trie(const KliCommand table[]);
+
+/**
+ * @brief Insert the names of a table and its subtables below a node.
+ * @param table Command table.
+ * @param node Node the names start from.
+ */
+static void insert_table(const KliCommand table[], int node);
+
+/**
+ * @brief Insert characters below a node.
+ * @param node Node the characters start from.
+ * @param string Characters to insert.
+ * @return Node of the last character, -1 if the node pool is full.
+ */
+static int insert_string(int node, const char *string);
+
+/**
+ * @brief Find the child of a node, or create it in sorted order.
+ * @param node Parent node.
+ * @param c Child character.
+ * @return Child node, -1 if the node pool is full.
+ */
+static int insert_child(int node, char c);
+
+/**
+ * @brief Find the child of a node.
+ * @param node Parent node, -1 for none.
+ * @param c Child character.
+ * @return Child node, -1 if not found.
+ */
+static int find_child(int node, char c);
+
+/**
+ * @brief Follow a typed character in the completion trie.
+ * @param input Input, the character is already appended to its line.
+ */
+static void follow_character(KliInput *input);
+
+/**
+ * @brief Follow the whole line in the completion trie, after erasing or recalling.
+ * @param input Input.
+ */
+static void follow_line(KliInput *input);
+
+/**
+ * @brief Append a character to the line, and echo it.
+ * @param input Input.
+ * @param c Character to append.
+ */
+static void append_character(KliInput *input, char c);
+
+/**
+ * @brief Complete the word being typed, or list candidates if ambiguous.
+ * @param input Input.
+ */
+static void complete_word(KliInput *input);
+
+/**
+ * @brief Print the names completing the word being typed.
+ * @param node Node reached by the word.
+ * @param suffix Buffer holding the characters following the word.
+ * @param length Length of the suffix.
+ */
+static void print_candidates(int node, char *suffix, int length);
+
+/**
+ * @brief Replace the line, and redraw it.
+ * @param input Input.
+ * @param line New line, NULL to clear.
+ */
+static void replace_line(KliInput *input, const char *line);
+
+/**
+ * @brief Dispatch the line, add it to history, and start a new one.
+ * @param input Input.
+ */
+static void submit_line(KliInput *input);
+
+/**
+ * @brief Add a line to history, dropping oldest lines to make room.
+ * @param input Input.
+ */
+static void add_history(KliInput *input);
+
+/**
+ * @brief Copy a history line.
+ * @param input Input.
+ * @param n Line index, 1 for the newest one.
+ * @param line Line return buffer of KLI_MAX_LINE_SIZE characters.
+ */
+static void get_history(const KliInput *input, int n, char *line);
+
+/**
+ * @brief Handle an escape sequence final byte.
+ * @param input Input.
+ * @param c Final byte.
+ */
+static void handle_escape(KliInput *input, char c);
+
+/**
+ * @brief Default interrupt function, cancels pending handlers and scheduled jobs.
+ * @param user Unused.
+ */
+static void cancel_all(void *user);
+
+// Implementations
+
+void kli_input_init(KliInput *input, const KliCommand table[], const char *prompt) {
+    input->table = table;
+    input->prompt = prompt;
+    input->length = 0;
+    input->historyStart = 0;
+    input->historyLength = 0;
+    input->historyCount = 0;
+    input->recall = 0;
+    input->escape = ESCAPE_NONE;
+    input->carriageReturn = false;
+    input->interrupt = cancel_all;
+    input->user = NULL;
+    follow_line(input);
+}
+
+void kli_input_feed(KliInput *input, const char *data, int length) {
+    build_trie(input->table);
+    for(int i = 0; i < length; i++) {
+        char c = data[i];
+
+        // Line ends, "\r\n" counts once
+        bool lineFeedAfterReturn = c == '\n' && input->carriageReturn;
+        input->carriageReturn = c == '\r';
+        if(lineFeedAfterReturn)
+            continue;
+
+        // Escape sequences, only arrows are handled
+        if(input->escape == ESCAPE_START)
+            input->escape = c == '[' || c == 'O' ? ESCAPE_SEQUENCE : ESCAPE_NONE;
+        else if(input->escape == ESCAPE_SEQUENCE) {
+            if(c >= 0x40 && c <= 0x7E)
+                handle_escape(input, c);
+        }
+        else if(c == KEY_ESCAPE)
+            input->escape = ESCAPE_START;
+
+        // Editing keys
+        else if(c == '\r' || c == '\n')
+            submit_line(input);
+        else if(c == KEY_TAB)
+            complete_word(input);
+        else if((c == KEY_DELETE || c == KEY_BACKSPACE) && input->length) {
+            --input->length;
+            kli_print("\b \b");
+            follow_line(input);
+        }
+        else if(c == KEY_CLEAR)
+            replace_line(input, NULL);
+        else if(c == KEY_INTERRUPT) {
+            kli_print("^C\n");
+            input->length = 0;
+            input->recall = 0;
+            follow_line(input);
+            if(input->interrupt)
+                input->interrupt(input->user);
+            if(input->prompt)
+                kli_print("%s", input->prompt);
+        }
+
+        // Printable characters
+        else if((unsigned char)c >= ' ' && c != KEY_DELETE)
+            append_character(input, c);
+    }
+    kli_flush();
+}
+
+// Static definitions
+
+static void build_trie(const KliCommand table[]) {
+    if(trieTable == table && nodeCount)
+        return;
+
+    // Root only, then names of built-ins and commands
+    memset(&nodes[0], 0, sizeof(nodes[0]));
+    nodeCount = 1;
+    insert_table(KLI_BUILTIN, 0);
+    if(table)
+        insert_table(table, 0);
+    trieTable = table;
+}
+
+static void insert_table(const KliCommand table[], int node) {
+    for(const KliCommand *entry = table; entry->name; entry++) {
+        int word = insert_string(node, entry->name);
+        if(word < 0)
+            return;
+        nodes[word].flags |= NODE_WORD;
+
+        // Subcommand names follow a space
+        if(entry->subcommands) {
+            int space = insert_child(word, ' ');
+            if(space >= 0)
+                insert_table(entry->subcommands, space);
+            continue;
+        }
+
+        // Long option names of parsed handlers follow a space
+        if(!entry->handler)
+            continue;
+        nodes[word].flags |= NODE_HANDLER;
+        if(!entry->options || (entry->flags & KLI_COMMAND_RAW))
+            continue;
+        int space = insert_child(word, ' ');
+        int dashes = insert_string(space, "--");
+        for(const KliOption *option = entry->options; dashes >= 0 && (option->shortName || option->longName); option++) {
+            int name = option->longName ? insert_string(dashes, option->longName) : -1;
+            if(name >= 0)
+                nodes[name].flags |= NODE_WORD;
+        }
+    }
+}
+
+static int insert_string(int node, const char *string) {
+    for(const char *c = string; *c && node >= 0; c++)
+        node = insert_child(node, *c);
+    return node;
+}
+
+static int insert_child(int node, char c) {
+    if(node < 0)
+        return -1;
+
+    // Find child, or its sorted position
+    uint16_t *link = &nodes[node].child;
+    while(*link && nodes[*link].c < c)
+        link = &nodes[*link].sibling;
+    if(*link && nodes[*link].c == c)
+        return *link;
+
+    // Pool full -> names not completed
+    if(nodeCount >= KLI_TRIE_NODES)
+        return -1;
+    nodes[nodeCount] = (TrieNode){c, 0, 0, *link};
+    *link = (uint16_t)nodeCount;
+    return nodeCount++;
+}
+
+static int find_child(int node, char c) {
+    if(node < 0)
+        return -1;
+    for(int child = nodes[node].child; child; child = nodes[child].sibling)
+        if(nodes[child].c == c)
+            return child;
+    return -1;
+}
+
+static void follow_character(KliInput *input) {
+    const char c = input->line[input->length - 1];
+    const char previous = input->length > 1 ? input->line[input->length - 2] : ' ';
+
+    // Other characters follow the word being typed
+    if(c != ' ') {
+        input->node = find_child(input->node, c);
+        return;
+    }
+
+    // Repeated and leading spaces don't start a new word
+    if(previous == ' ')
+        return;
+
+    // Operators start a new command
+    int start = input->length - 1;
+    while(start > 0 && input->line[start - 1] != ' ')
+        --start;
+    const char *word = &input->line[start];
+    const int length = input->length - 1 - start;
+    if((length == 1 && (*word == ';' || *word == '|')) || (length == 2 && !strncmp(word, "&&", 2))) {
+        input->node = 0;
+        input->handler = -1;
+        return;
+    }
+
+    // Words following a complete handler name are its options, otherwise subcommand names
+    if(input->handler < 0 && input->node >= 0 && (nodes[input->node].flags & NODE_HANDLER))
+        input->handler = input->node;
+    input->node = find_child(input->handler >= 0 ? input->handler : input->node, ' ');
+}
+
+static void follow_line(KliInput *input) {
+    const int length = input->length;
+    input->node = 0;
+    input->handler = -1;
+    for(input->length = 1; input->length <= length; input->length++)
+        follow_character(input);
+    input->length = length;
+}
+
+static void append_character(KliInput *input, char c) {
+
+    // Line full, ring the bell
+    if(input->length >= KLI_MAX_LINE_SIZE - 1) {
+        kli_print("\a");
+        return;
+    }
+    input->line[input->length++] = c;
+    kli_print("%c", c);
+    follow_character(input);
+}
+
+static void complete_word(KliInput *input) {
+    if(input->node < 0)
+        return;
+
+    // Extend the word while a single name continues it
+    bool extended = false;
+    for(;;) {
+        const TrieNode * const node = &nodes[input->node];
+        if((node->flags & NODE_WORD) || !node->child || nodes[node->child].sibling || nodes[node->child].c == ' ')
+            break;
+        append_character(input, nodes[node->child].c);
+        extended = true;
+    }
+
+    // Complete name without longer candidates -> end the word
+    const TrieNode * const node = &nodes[input->node];
+    const int child = node->child;
+    const bool longer = child && (nodes[child].c != ' ' || nodes[child].sibling);
+    if((node->flags & NODE_WORD) && !longer) {
+        append_character(input, ' ');
+        return;
+    }
+    if(extended)
+        return;
+
+    // Ambiguous -> list candidates, then redraw the line
+    char suffix[KLI_MAX_LINE_SIZE];
+    int start = input->length;
+    while(start > 0 && input->line[start - 1] != ' ')
+        --start;
+    memcpy(suffix, &input->line[start], input->length - start);
+    kli_print("\n");
+    print_candidates(input->node, suffix, input->length - start);
+    kli_print("\n%s%.*s", input->prompt ? input->prompt : "", input->length, input->line);
+}
+
+static void print_candidates(int node, char *suffix, int length) {
+    if(nodes[node].flags & NODE_WORD)
+        kli_print("%.*s  ", length, suffix);
+
+    // Candidates end at a space
+    for(int child = nodes[node].child; child && length < KLI_MAX_LINE_SIZE; child = nodes[child].sibling) {
+        if(nodes[child].c == ' ')
+            continue;
+        suffix[length] = nodes[child].c;
+        print_candidates(child, suffix, length + 1);
+    }
+}
+
+static void replace_line(KliInput *input, const char *line) {
+    input->length = 0;
+    if(line) {
+        input->length = strlen(line);
+        memcpy(input->line, line, input->length);
+    }
+
+    // Return to the line start, and erase to its end
+    kli_print("\r\033[K%s%.*s", input->prompt ? input->prompt : "", input->length, input->line);
+    follow_line(input);
+}
+
+static void submit_line(KliInput *input) {
+    char *argv[KLI_MAX_ARGC];
+    kli_print("\n");
+    input->line[input->length] = '\0';
+    add_history(input);
+
+    // Tokens are parsed in place, the line is reset right after
+    int argc = kli_parse_line(input->line, argv);
+    kli_dispatch(input->table, argc, argv);
+    if(input->prompt)
+        kli_print("%s", input->prompt);
+    input->length = 0;
+    input->recall = 0;
+    follow_line(input);
+}
+
+static void add_history(KliInput *input) {
+    const int size = input->length + 1;
+
+    // Skip empty lines, lines too long and repeated lines
+    if(!input->length || size > KLI_HISTORY_SIZE)
+        return;
+    if(input->historyCount) {
+        char newest[KLI_MAX_LINE_SIZE];
+        get_history(input, 1, newest);
+        if(!strcmp(newest, input->line))
+            return;
+    }
+
+    // Drop oldest lines until the line fits
+    while(input->historyLength + size > KLI_HISTORY_SIZE) {
+        int dropped = 0;
+        while(input->history[(input->historyStart + dropped) % KLI_HISTORY_SIZE])
+            ++dropped;
+        ++dropped;
+        input->historyStart = (input->historyStart + dropped) % KLI_HISTORY_SIZE;
+        input->historyLength -= dropped;
+        --input->historyCount;
+    }
+
+    // Append line with its null terminator
+    for(int i = 0; i < size; i++)
+        input->history[(input->historyStart + input->historyLength + i) % KLI_HISTORY_SIZE] = input->line[i];
+    input->historyLength += size;
+    ++input->historyCount;
+}
+
+static void get_history(const KliInput *input, int n, char *line) {
+
+    // Walk back from the newest line terminator
+    int end = input->historyLength - 1;
+    for(int i = 1;; i++) {
+        int begin = end;
+        while(begin > 0 && input->history[(input->historyStart + begin - 1) % KLI_HISTORY_SIZE])
+            --begin;
+        if(i == n) {
+            for(int j = begin; j <= end; j++)
+                line[j - begin] = input->history[(input->historyStart + j) % KLI_HISTORY_SIZE];
+            return;
+        }
+        end = begin - 1;
+    }
+}
+
+static void handle_escape(KliInput *input, char c) {
+    char line[KLI_MAX_LINE_SIZE];
+    input->escape = ESCAPE_NONE;
+
+    // Up -> older line
+    if(c == 'A' && input->recall < input->historyCount) {
+        get_history(input, ++input->recall, line);
+        replace_line(input, line);
+    }
+
+    // Down -> newer line, or a new empty line
+    else if(c == 'B' && input->recall > 0) {
+        if(--input->recall)
+            get_history(input, input->recall, line);
+        replace_line(input, input->recall ? line : NULL);
+    }
+}
+
+static void cancel_all(void *user) {
+    (void)user;
+    kli_cancel();
+}
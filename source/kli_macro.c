@@ -0,0 +1,440 @@
+/**
+ * @file kli_macro.c
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI macro implementation, macros stored contiguously in a bounded pool shared by all threads behind a spinlock.
+ */
+
+// Includes
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "kli_macro.h"
+#include "kli_config.h"
+#include "kli_emit.h"
+#include "kli_parse.h"
+#include "kli_print.h"
+
+// Definitions
+
+#define MACRO_NO_VALUE                  0xFFFF  // Slot value of an option found without value.
+
+// Static structures
+
+/**
+ * @brief Macro, followed by its steps.
+ * @note Macros are contiguous from the start of the pool, in definition order.
+ */
+typedef struct Macro {
+
+    // Size of the macro and its steps.
+    unsigned short size;
+
+    // Number of steps.
+    unsigned char steps;
+
+    // Null terminated name.
+    char name[KLI_MACRO_NAME_SIZE];
+
+} Macro;
+
+/**
+ * @brief Resolved command of a macro, followed by its slots, then by its tokens.
+ * @note Tokens are copied from a KliResolved line, the command string then each option and argument token.
+ */
+typedef struct Step {
+
+    // Top level table the command was resolved from.
+    const KliCommand *table;
+
+    // Handler entry.
+    const KliCommand *entry;
+
+    // Size of the step, slots and tokens.
+    unsigned short size;
+
+    // Length of the tokens, null bytes included.
+    unsigned short length;
+
+    // Number of slots.
+    unsigned char slots;
+
+    // Step is only called if the previous one succeeded, i.e. it follows '&&'.
+    bool chained;
+
+} Step;
+
+/**
+ * @brief Option or argument found while resolving a step.
+ */
+typedef struct Slot {
+
+    // Offset of the value in the step tokens, MACRO_NO_VALUE for an option without value.
+    unsigned short value;
+
+    // Option or argument index.
+    unsigned char index;
+
+    // Slot holds an argument.
+    bool argument;
+
+} Slot;
+
+// Static variables
+
+static _Alignas(Step) unsigned char pool[KLI_MACRO_POOL_SIZE];
+static size_t poolUsed = 0;
+static atomic_flag locked = ATOMIC_FLAG_INIT;
+static KLI_THREAD_LOCAL _Alignas(Step) unsigned char staging[KLI_MACRO_POOL_SIZE];
+static KLI_THREAD_LOCAL _Alignas(Step) unsigned char snapshot[KLI_MACRO_POOL_SIZE];
+static KLI_THREAD_LOCAL KliResolved resolving;
+static KLI_THREAD_LOCAL KliOptargs replaying;
+
+// Static prototypes
+
+/**
+ * @brief Find a macro by name.
+ * @param name Macro name.
+ * @return Macro, NULL if not defined.
+ * @note Pool lock must be held.
+ */
+static Macro *find_macro(const char *name);
+
+/**
+ * @brief Remove a macro, moving the following ones down.
+ * @param macro Macro to remove.
+ * @note Pool lock must be held.
+ */
+static void remove_macro(Macro *macro);
+
+/**
+ * @brief Resolve a command and append it as a step after the macro being defined.
+ * @param table Top level table.
+ * @param end Staging offset the step is written at, moved after it.
+ * @param chained Step follows '&&'.
+ * @param argc Argument count.
+ * @param argv Argument values.
+ * @return True if the step was resolved and fits in the staging buffer, false otherwise.
+ */
+static bool add_step(const KliCommand table[], size_t *end, bool chained, int argc, char **argv);
+
+/**
+ * @brief Call the handler of a step with its stored options and arguments.
+ * @param step Step to call.
+ * @return True if the handler succeeded, false otherwise.
+ */
+static bool call_step(const Step *step);
+
+/**
+ * @brief Round a size up, so the next macro or step is aligned.
+ * @param size Size to round.
+ * @return Aligned size.
+ */
+static inline size_t align_size(size_t size);
+
+/**
+ * @brief Print an error about a name, as a record once the encoding is not text.
+ * @param name Macro or command name.
+ * @param message Error message.
+ */
+static void print_error(const char *name, const char *message);
+
+/**
+ * @brief Print a token of a listed macro.
+ * @param structured Write it as a string of the current array, instead of text.
+ * @param token Token or operator.
+ */
+static void print_token(bool structured, const char *token);
+
+/**
+ * @brief Take the pool lock, held only while macros are read or written, never while resolving, calling or printing.
+ */
+static inline void lock(void);
+
+/**
+ * @brief Release the pool lock.
+ */
+static inline void unlock(void);
+
+// Implementations
+
+bool kli_macro_define(const KliCommand table[], const char *name, int argc, char **argv) {
+
+    // Name must be callable, top level commands are looked up before macros
+    if(strlen(name) >= KLI_MACRO_NAME_SIZE) {
+        print_error(name, "macro name too long, KLI_MACRO_NAME_SIZE reached");
+        return false;
+    }
+    for(const KliCommand *entry = KLI_BUILTIN; entry->name; entry++)
+        if(!strcmp(entry->name, name)) {
+            print_error(name, "name already used by a command");
+            return false;
+        }
+    for(const KliCommand *entry = table; entry->name; entry++)
+        if(!strcmp(entry->name, name)) {
+            print_error(name, "name already used by a command");
+            return false;
+        }
+
+    // Build macro in the staging buffer, steps are resolved and errors printed without holding the lock
+    Macro * const macro = (Macro *)staging;
+    size_t end = align_size(sizeof(Macro));
+    if(end > KLI_MACRO_POOL_SIZE) {
+        print_error(name, "no room left, KLI_MACRO_POOL_SIZE reached");
+        return false;
+    }
+
+    // Commands end at an operator or at the end of the sequence, each is resolved once
+    int steps = 0;
+    int start = 0;
+    bool chained = false;
+    for(int i = 0; i <= argc; i++) {
+        bool isEnd = i == argc;
+        if(!isEnd && !strcmp(argv[i], KLI_PIPE_OPERATOR)) {
+            print_error(name, "pipes can't be stored in macros");
+            return false;
+        }
+        bool isAnd = !isEnd && !strcmp(argv[i], KLI_AND_OPERATOR);
+        if(!isEnd && !isAnd && strcmp(argv[i], KLI_SEQUENCE_OPERATOR))
+            continue;
+        if(i > start) {
+            if(steps == 255 || !add_step(table, &end, chained, i - start, &argv[start]))
+                return false;
+            ++steps;
+        }
+        chained = isAnd;
+        start = i + 1;
+    }
+    if(!steps) {
+        print_error(name, "expected command");
+        return false;
+    }
+
+    macro->size = end;
+    macro->steps = steps;
+    strcpy(macro->name, name);
+
+    // Append macro after the defined ones, a redefinition replaces the previous macro if the result fits
+    lock();
+    Macro * const previous = find_macro(name);
+    const bool fits = poolUsed - (previous ? previous->size : 0) + end <= KLI_MACRO_POOL_SIZE;
+    if(fits) {
+        if(previous)
+            remove_macro(previous);
+        memcpy(&pool[poolUsed], staging, end);
+        poolUsed += end;
+    }
+    unlock();
+    if(!fits)
+        print_error(name, "no room left, KLI_MACRO_POOL_SIZE reached");
+    return fits;
+}
+
+bool kli_macro_remove(const char *name) {
+    lock();
+    Macro * const macro = find_macro(name);
+    if(macro)
+        remove_macro(macro);
+    unlock();
+    return macro != NULL;
+}
+
+bool kli_macro_defined(const char *name) {
+    lock();
+    const bool defined = find_macro(name) != NULL;
+    unlock();
+    return defined;
+}
+
+bool kli_macro_call(const char *name, bool *succeeded) {
+
+    // Copy macro out of the pool, handlers are called without holding the lock
+    lock();
+    const Macro * const found = find_macro(name);
+    if(found)
+        memcpy(snapshot, found, found->size);
+    unlock();
+    if(!found)
+        return false;
+    const Macro * const macro = (const Macro *)snapshot;
+
+    // Call steps in order, '&&' skips the next step once a step failed, like kli_dispatch
+    bool skipping = false;
+    *succeeded = true;
+    const unsigned char *cursor = (const unsigned char *)macro + align_size(sizeof(Macro));
+    for(int i = 0; i < macro->steps; i++) {
+        const Step * const step = (const Step *)cursor;
+        cursor += step->size;
+        skipping = step->chained && (skipping || !*succeeded);
+        if(!skipping)
+            *succeeded = call_step(step);
+    }
+    return true;
+}
+
+void kli_macro_list(void) {
+
+    // Copy pool, macros are printed without holding the lock
+    lock();
+    const size_t used = poolUsed;
+    memcpy(snapshot, pool, used);
+    unlock();
+
+    // Structured output -> one record holding the macros, tokens and operators in an array each
+    const bool structured = kli_emit_encoding() != KLI_ENCODING_TEXT;
+    if(structured)
+        kli_emit_begin_array("macros");
+    else
+        kli_print("\t[MACRO(S)]\n\n");
+    for(size_t offset = 0; offset < used;) {
+        const Macro * const macro = (const Macro *)&snapshot[offset];
+        if(structured) {
+            kli_emit_begin_object(NULL);
+            kli_emit_str("name", macro->name);
+            kli_emit_begin_array("commands");
+        }
+        else
+            kli_print("\t\t%s -", macro->name);
+
+        // Print tokens of each step, with its operator
+        const unsigned char *cursor = (const unsigned char *)macro + align_size(sizeof(Macro));
+        for(int i = 0; i < macro->steps; i++) {
+            const Step * const step = (const Step *)cursor;
+            const char *token = (const char *)((const Slot *)(step + 1) + step->slots);
+            if(i)
+                print_token(structured, step->chained ? KLI_AND_OPERATOR : KLI_SEQUENCE_OPERATOR);
+            for(const char *t = token; t < token + step->length; t += strlen(t) + 1)
+                print_token(structured, t);
+            cursor += step->size;
+        }
+        if(structured) {
+            kli_emit_end_array();
+            kli_emit_end_object();
+        }
+        else
+            kli_print("\n");
+        offset += macro->size;
+    }
+    if(structured)
+        kli_emit_end_array();
+}
+
+// Static definitions
+
+static Macro *find_macro(const char *name) {
+    for(size_t offset = 0; offset < poolUsed;) {
+        Macro * const macro = (Macro *)&pool[offset];
+        if(!strcmp(macro->name, name))
+            return macro;
+        offset += macro->size;
+    }
+    return NULL;
+}
+
+static void remove_macro(Macro *macro) {
+
+    // Move following macros down, they stay aligned as sizes are
+    const size_t offset = (unsigned char *)macro - pool;
+    const size_t size = macro->size;
+    memmove(macro, &pool[offset + size], poolUsed - offset - size);
+    poolUsed -= size;
+}
+
+static bool add_step(const KliCommand table[], size_t *end, bool chained, int argc, char **argv) {
+
+    // Resolve names and parse options and arguments once
+    const char *error = kli_resolve(table, argc, argv, &resolving);
+    if(error) {
+        print_error(argv[0], error);
+        return false;
+    }
+
+    // Resolved line holds the command string then the tokens, as long as the tokens themselves
+    size_t length = 0;
+    for(int i = 0; i < argc; i++)
+        length += strlen(argv[i]) + 1;
+
+    // Collect found options and arguments, values as offsets in the line
+    const KliOptargs * const optargs = &resolving.optargs;
+    int slots = 0;
+    for(int opti = 0; opti < optargs->options; opti++)
+        slots += optargs->optFound[opti] ? (optargs->optvLength[opti] ? optargs->optvLength[opti] : 1) : 0;
+    for(int argi = 0; argi < optargs->arguments; argi++)
+        slots += optargs->argFound[argi];
+
+    // Ensure step fits
+    const size_t size = align_size(sizeof(Step) + slots * sizeof(Slot) + length);
+    if(*end + size > KLI_MACRO_POOL_SIZE || slots > 255) {
+        print_error(argv[0], "no room left, KLI_MACRO_POOL_SIZE reached");
+        return false;
+    }
+
+    // Write step, slots and tokens
+    Step * const step = (Step *)&staging[*end];
+    *step = (Step){resolving.table, resolving.entry, size, length, slots, chained};
+    Slot *slot = (Slot *)(step + 1);
+    for(int opti = 0; opti < optargs->options; opti++) {
+        if(!optargs->optFound[opti])
+            continue;
+        if(!optargs->optvLength[opti])
+            *slot++ = (Slot){MACRO_NO_VALUE, opti, false};
+        for(int i = 0; i < optargs->optvLength[opti]; i++)
+            *slot++ = (Slot){optargs->optv[optargs->optvOffset[opti] + i] - resolving.line, opti, false};
+    }
+    for(int argi = 0; argi < optargs->arguments; argi++)
+        if(optargs->argFound[argi])
+            *slot++ = (Slot){optargs->argv[argi] - resolving.line, argi, true};
+    memcpy(slot, resolving.line, length);
+    *end += size;
+    return true;
+}
+
+static bool call_step(const Step *step) {
+    const Slot * const slots = (const Slot *)(step + 1);
+    char * const line = (char *)&slots[step->slots];
+
+    // Restore options and arguments from their slots, without parsing tokens again
+    KliOptargs *previous = kli_optargs_bind(&replaying);
+    kli_optargs_reset(step->entry->options, step->entry->arguments);
+    for(int i = 0; i < step->slots; i++) {
+        char * const value = slots[i].value == MACRO_NO_VALUE ? NULL : &line[slots[i].value];
+        if(slots[i].argument)
+            kli_optargs_set_arg(slots[i].index, value);
+        else
+            kli_optargs_set_opt(slots[i].index, value);
+    }
+    kli_optargs_bind(previous);
+
+    // Call handler, line starts with the command string
+    const char *error = kli_invoke_entry(step->table, step->entry, &replaying);
+    if(error)
+        print_error(line, error);
+    return !error;
+}
+
+static inline size_t align_size(size_t size) {
+    return (size + _Alignof(Step) - 1) / _Alignof(Step) * _Alignof(Step);
+}
+
+static void print_error(const char *name, const char *message) {
+    if(!kli_emit_error(message, name))
+        kli_print("\t'%s' - %s\n\n", name, message);
+}
+
+static void print_token(bool structured, const char *token) {
+    if(structured)
+        kli_emit_str(NULL, token);
+    else
+        kli_print(" %s", token);
+}
+
+static inline void lock(void) {
+    while(atomic_flag_test_and_set(&locked))
+        ;
+}
+
+static inline void unlock(void) {
+    atomic_flag_clear(&locked);
+}
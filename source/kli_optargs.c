@@ -7,20 +7,18 @@
 
 // Includes
 
+#include <stdio.h>
 #include <string.h>
 #include "kli_parse.h"
 #include "kli_config.h"
+#include "kli_emit.h"
 #include "kli_print.h"
 #include "kli_optargs.h"
 
 // Static variables
 
-static bool tokenParsed[KLI_MAX_ARGC] = {false};
-static char argFound[KLI_MAX_ARGC] = {false};
-static char *argvBuffer[KLI_MAX_ARGC] = {NULL};
-static char optFound[KLI_MAX_ARGC] = {false};
-static int optvLength[KLI_MAX_ARGC] = {0};
-static char *optvBuffer[KLI_MAX_ARGC][KLI_MAX_ARGC] = {NULL};
+static KLI_THREAD_LOCAL KliOptargs defaultContext = {0};
+static KLI_THREAD_LOCAL KliOptargs *boundContext = NULL;
 
 // Static prototypes
 
@@ -32,174 +30,359 @@ static char *optvBuffer[KLI_MAX_ARGC][KLI_MAX_ARGC] = {NULL};
 static inline bool is_alphabetic(char c);
 
 /**
- * @brief Check if string is a short option (e.g. -a).
+ * @brief Reset the slots of a context used by a pair of tables, and lay out option values.
+ * @param context Context to reset.
+ * @param options Option table.
+ * @param layout Layout of the option and argument tables.
+ * @return True if the tables fit in the context slots, false otherwise.
+ */
+static bool reset_context(KliOptargs *context, const KliOption options[], const KliOptargsLayout *layout);
+
+/**
+ * @brief Get the bound context, or the default one.
+ * @return Options and arguments context.
+ */
+static inline KliOptargs *get_context(void);
+
+/**
+ * @brief Find an option from its short name.
+ * @param options Option table, or NULL.
+ * @param name Short name.
+ * @return Option index, -1 if not found.
+ */
+static int find_short_option(const KliOption options[], char name);
+
+/**
+ * @brief Find an option from its long name.
+ * @param options Option table, or NULL.
+ * @param name Long name, not necessarily null terminated.
+ * @param length Long name length.
+ * @return Option index, -1 if not found.
+ */
+static int find_long_option(const KliOption options[], const char *name, size_t length);
+
+/**
+ * @brief Mark an option as found, and take its values.
+ * @param context Context being parsed.
+ * @param option Option found.
+ * @param opti Option index.
+ * @param isLong True if the option was given by its long name, for error messages.
+ * @param attached First value, attached to the option token, NULL if none.
+ * @param index Index of the option token, moved to the last value token.
+ * @param argc Token count.
+ * @param argv Tokens.
+ * @return True if the option was not already found and got all its values, false otherwise.
+ */
+static bool set_option(KliOptargs *context, const KliOption *option, int opti, bool isLong, char *attached, int *index, int argc, char **argv);
+
+/**
+ * @brief Print a parsing error about a token, as text or as a structured record.
+ * @param prefix Prefix of the name, e.g. '--'.
+ * @param name Option name or argument token, not necessarily null terminated.
+ * @param length Name length.
+ * @param kind Text after the quoted name, e.g. ' option', or an empty string.
+ * @param error Error message.
+ */
+static void print_error(const char *prefix, const char *name, int length, const char *kind, const char *error);
+
+/**
+ * @brief Check if string is a short option, or bundled short options (e.g. -a, -abc or -s100).
  * @param string Null terminated string.
  * @return True is string is a short option, false otherwise.
  */
 static inline bool is_short_option(const char *string);
 
 /**
- * @brief Check if string is a long option (e.g. --all).
+ * @brief Check if string is a long option (e.g. --all or --speed=100).
  * @param string Null terminated string.
- * @return True is string is a short option, false otherwise.
+ * @return True is string is a long option, false otherwise.
  */
 static inline bool is_long_option(const char *string);
 
 // Implementations
 
 bool kli_optargs(const KliOption options[], const KliArgument arguments[], int argc, char **argv) {
+    KliOptargsLayout layout;
+    kli_optargs_layout(options, arguments, &layout);
+    return kli_optargs_resolved(options, arguments, &layout, argc, argv);
+}
+
+void kli_optargs_layout(const KliOption options[], const KliArgument arguments[], KliOptargsLayout *layout) {
+    layout->options = 0;
+    layout->arguments = 0;
+    layout->values = 0;
 
-    // Reset caches
-    for(int i = 0; i < KLI_MAX_ARGC; i++) {
-        tokenParsed[i] = false;
-        argFound[i] = false;
-        argvBuffer[i] = NULL;
-        optFound[i] = false;
-        optvLength[i] = 0;
-        for(int j = 0; j < KLI_MAX_ARGC; j++)
-            optvBuffer[i][j] = NULL;
+    // Count options and their values
+    for(const KliOption *option = options; option && (option->shortName || option->longName); option++) {
+        ++layout->options;
+        layout->values += option->argc;
     }
 
-    // Search options
-    if(options) {
-        int opti = 0;
-        for(const KliOption *option = options; option->shortName || option->longName; option++) {
-            for(int i = 0; i < argc;) {
-                
-                // Token already parsed, skip
-                if(tokenParsed[i]) {
-                    ++i;
-                    continue;
-                }
-                
-                // Skip if not the searched option
-                bool shortNameFound = is_short_option(argv[i]) && argv[i][1] == option->shortName && !argv[i][2];
-                bool longNameFound = is_long_option(argv[i]) && !strcmp(&argv[i][2], option->longName);
-                if(!shortNameFound && !longNameFound) {
-                    ++i;
-                    continue;
-                }
+    // Count arguments
+    for(const KliArgument *argument = arguments; argument && argument->name; argument++)
+        ++layout->arguments;
+}
 
-                // Ensure option was not already specified
-                if(optFound[opti]) {
-                    if(shortNameFound)
-                        kli_print("\t'-%c' option - already specified\n\n", option->shortName);
-                    if(longNameFound)
-                        kli_print("\t'--%s' option - already specified\n\n", option->longName);
-                    return false;
-                }
-                
-                // Mark option as found
-                tokenParsed[i++] = true;
-                optFound[opti] = true;
-                optvLength[opti] = option->argc;
-                if(!option->argc)
-                    break;
+bool kli_optargs_resolved(const KliOption options[], const KliArgument arguments[], const KliOptargsLayout *layout, int argc, char **argv) {
+    KliOptargs * const context = get_context();
+    (void)arguments;
 
-                // Count number of valid tokens following the option.
-                int remainingUnparsedTokens = 0;
-                for(int j = 0; (j < option->argc) && (i + j < argc); j++) {
-                    if(tokenParsed[i + j] || is_short_option(argv[i + j]) || is_long_option(argv[i + j]))
-                        break;
-                    else
-                        ++remainingUnparsedTokens;
-                }
+    // Reset context
+    if(!reset_context(context, options, layout))
+        return false;
 
-                // Ensure enough arguments follow the option
-                if(remainingUnparsedTokens < option->argc) {
-                    if(shortNameFound)
-                        kli_print("\t'-%c' option - not enough arguments\n\n", option->shortName);
-                    if(longNameFound)
-                        kli_print("\t'--%s' option - not enough arguments\n\n", option->longName);
-                    return false;
-                }
+    // Read tokens once, options may come anywhere until the end of options marker
+    bool optionsEnded = false;
+    int argi = 0;
+    for(int i = 0; i < argc; i++) {
+        char * const token = argv[i];
 
-                // Save option values
-                for(int j = 0; j < option->argc; j++) {
-                    optvBuffer[opti][j] = argv[i];
-                    tokenParsed[i++] = true;
-                }
-            }
-            ++opti;
+        // End of options marker -> next tokens are arguments
+        if(!optionsEnded && !strcmp(token, KLI_END_OF_OPTIONS)) {
+            optionsEnded = true;
+            continue;
         }
-    }
-
-    // Search arguments
-    if(arguments) {
-        int argi = 0;
-        for(const KliArgument *argument = arguments; argument->name; argument++) {
-            for(int i = 0; i < argc; i++) {
 
-                // Token already parsed, skip
-                if(tokenParsed[i])
-                    continue;
+        // Long option, its first value may be attached after '='
+        if(!optionsEnded && is_long_option(token)) {
+            char *name = &token[2];
+            char *value = strchr(name, '=');
+            const size_t length = value ? (size_t)(value - name) : strlen(name);
+            const int opti = find_long_option(options, name, length);
+            if(opti < 0) {
+                print_error("--", name, length, "", "unrecognized option");
+                return false;
+            }
+            if(!set_option(context, &options[opti], opti, true, value ? &value[1] : NULL, &i, argc, argv))
+                return false;
+            continue;
+        }
 
-                // Encoutered an unmarked option
-                if(is_short_option(argv[i])) {
-                    kli_print("\t'-%c' - unrecognized option\n\n", argv[i][1]);
+        // Bundled short options, until one taking values, its first value may be attached
+        if(!optionsEnded && is_short_option(token)) {
+            for(char *name = &token[1]; *name; name++) {
+                const int opti = find_short_option(options, *name);
+                if(opti < 0) {
+                    print_error("-", name, 1, "", "unrecognized option");
                     return false;
                 }
-                if(is_long_option(argv[i])) {
-                    kli_print("\t'--%s' - unrecognized option\n\n", &argv[i][1]);
+                const bool takesValues = options[opti].argc > 0;
+                if(!set_option(context, &options[opti], opti, false, takesValues && name[1] ? &name[1] : NULL, &i, argc, argv))
                     return false;
-                }
-
-                // Save argument value
-                argFound[argi] = true;
-                argvBuffer[argi] = argv[i];
-                tokenParsed[i] = true;
+                if(takesValues)
+                    break;
             }
-            ++argi;
+            continue;
         }
-    }
 
-    // Check for any unparsed argument
-    for(int i = 0; i < argc; i++) {
-        if(!tokenParsed[i]) {
-            kli_print("\t'%s' - unrecognized argument\n\n", argv[i]);
+        // Argument, takes the next argument slot
+        if(argi >= context->arguments) {
+            print_error("", token, strlen(token), "", "unrecognized argument");
             return false;
         }
+        context->argFound[argi] = true;
+        context->argv[argi++] = token;
     }
 
     // All argument succesfully parsed
     return true;
 }
 
+bool kli_optargs_reset(const KliOption options[], const KliArgument arguments[]) {
+    KliOptargsLayout layout;
+    kli_optargs_layout(options, arguments, &layout);
+    return reset_context(get_context(), options, &layout);
+}
+
+bool kli_optargs_set_opt(int opti, char *optv) {
+    KliOptargs * const context = get_context();
+
+    // Option out of the table
+    if(opti < 0 || opti >= context->options)
+        return false;
+
+    // Mark option as found, and append its value if any
+    context->optFound[opti] = true;
+    if(optv)
+        context->optv[context->optvOffset[opti] + context->optvLength[opti]++] = optv;
+    return true;
+}
+
+bool kli_optargs_set_arg(int argi, char *argv) {
+    KliOptargs * const context = get_context();
+
+    // Argument out of the table
+    if(argi < 0 || argi >= context->arguments)
+        return false;
+
+    // Mark argument as found, with its value
+    context->argFound[argi] = true;
+    context->argv[argi] = argv;
+    return true;
+}
+
+KliOptargs *kli_optargs_bind(KliOptargs *optargs) {
+    KliOptargs *previous = boundContext;
+    boundContext = optargs;
+    return previous;
+}
+
 bool kli_get_opt(int opti, char **optv) {
+    KliOptargs * const context = get_context();
 
     // Option was not found
-    if(!optFound[opti])
+    if(opti < 0 || opti >= context->options || !context->optFound[opti])
         return false;
 
     // Return option without value(s) found
-    if(!optvLength[opti])
+    if(!context->optvLength[opti])
         return true;
     
     // Return option with value(s) found
-    for(int i = 0; i < optvLength[opti]; i++)
-        optv[i] = optvBuffer[opti][i];
+    for(int i = 0; i < context->optvLength[opti]; i++)
+        optv[i] = context->optv[context->optvOffset[opti] + i];
     return true;
 }
 
+char *kli_get_optv(int opti, int offset) {
+    KliOptargs * const context = get_context();
+
+    // Option was not found
+    if(opti < 0 || opti >= context->options || !context->optFound[opti])
+        return NULL;
+
+    // Offset out of the option values
+    if(offset < context->optvOffset[opti] || offset >= context->optvOffset[opti] + context->optvLength[opti])
+        return NULL;
+
+    // Return value from its storage offset
+    return context->optv[offset];
+}
+
 bool kli_get_arg(int argi, char **argv) {
+    KliOptargs * const context = get_context();
     
     // Argument was not found
-    if(!argFound[argi])
+    if(argi < 0 || argi >= context->arguments || !context->argFound[argi])
         return false;
     
     // Write output value
-    *argv = argvBuffer[argi];
+    *argv = context->argv[argi];
     return true;
 }
 
 // Static definitions
 
+static bool reset_context(KliOptargs *context, const KliOption options[], const KliOptargsLayout *layout) {
+
+    // Ensure tables fit in the slots
+    context->options = 0;
+    context->arguments = 0;
+    if(layout->options > KLI_MAX_ARGC || layout->arguments > KLI_MAX_ARGC || layout->values > KLI_MAX_OPTV) {
+        kli_print("\tOption or argument table - more than KLI_MAX_ARGC entries or KLI_MAX_OPTV values\n\n");
+        return false;
+    }
+
+    // Reset slots used by the tables only
+    for(int i = 0; i < layout->arguments; i++) {
+        context->argFound[i] = false;
+        context->argv[i] = NULL;
+    }
+    for(int i = 0; i < layout->options; i++) {
+        context->optFound[i] = false;
+        context->optvLength[i] = 0;
+    }
+    for(int i = 0; i < layout->values; i++)
+        context->optv[i] = NULL;
+    context->options = layout->options;
+    context->arguments = layout->arguments;
+
+    // Lay out option values contiguously, in declaration order
+    int offset = 0;
+    for(int opti = 0; opti < layout->options; opti++) {
+        context->optvOffset[opti] = offset;
+        offset += options[opti].argc;
+    }
+    return true;
+}
+
+static int find_short_option(const KliOption options[], char name) {
+    int opti = 0;
+    for(const KliOption *option = options; option && (option->shortName || option->longName); option++, opti++)
+        if(option->shortName == name)
+            return opti;
+    return -1;
+}
+
+static int find_long_option(const KliOption options[], const char *name, size_t length) {
+    int opti = 0;
+    for(const KliOption *option = options; option && (option->shortName || option->longName); option++, opti++)
+        if(option->longName && !strncmp(option->longName, name, length) && !option->longName[length])
+            return opti;
+    return -1;
+}
+
+static bool set_option(KliOptargs *context, const KliOption *option, int opti, bool isLong, char *attached, int *index, int argc, char **argv) {
+    const char *error = NULL;
+
+    // Ensure option was not already specified, and flags get no value
+    if(context->optFound[opti])
+        error = "already specified";
+    else if(!option->argc && attached)
+        error = "takes no value";
+
+    // Take the attached value, then the next tokens until an option
+    else {
+        char ** const values = &context->optv[context->optvOffset[opti]];
+        int count = 0;
+        if(attached)
+            values[count++] = attached;
+        while(count < option->argc && *index + 1 < argc) {
+            char * const token = argv[*index + 1];
+            if(is_short_option(token) || is_long_option(token) || !strcmp(token, KLI_END_OF_OPTIONS))
+                break;
+            values[count++] = token;
+            ++*index;
+        }
+        context->optFound[opti] = true;
+        context->optvLength[opti] = option->argc;
+        if(count < option->argc)
+            error = "not enough arguments";
+    }
+
+    // Print error with the name the option was given by
+    if(error && isLong)
+        print_error("--", option->longName, strlen(option->longName), " option", error);
+    else if(error)
+        print_error("-", &option->shortName, 1, " option", error);
+    return !error;
+}
+
+static void print_error(const char *prefix, const char *name, int length, const char *kind, const char *error) {
+    if(kli_emit_encoding() == KLI_ENCODING_TEXT) {
+        kli_print("\t'%s%.*s'%s - %s\n\n", prefix, length, name, kind, error);
+        return;
+    }
+
+    // Structured output -> error record with the token as given
+    char token[KLI_MAX_LINE_SIZE] = {0};
+    snprintf(token, KLI_MAX_LINE_SIZE, "%s%.*s", prefix, length, name);
+    kli_emit_begin_object(NULL);
+    kli_emit_str("error", error);
+    kli_emit_str("name", token);
+    kli_emit_end_object();
+}
+
+static inline KliOptargs *get_context(void) {
+    return boundContext ? boundContext : &defaultContext;
+}
+
 static inline bool is_alphabetic(char c) {
     return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z');
 }
 
 static inline bool is_short_option(const char *string) {
-    return string[0] == '-' && is_alphabetic(string[1]) && string[2] == '\0';
+    return string[0] == '-' && is_alphabetic(string[1]);
 }
 
 static inline bool is_long_option(const char *string) {
@@ -12,14 +12,44 @@
 #include "kli_parse.h"
 #include "kli_config.h"
 
+// Static variables
+
+static char sequenceOperator[] = KLI_SEQUENCE_OPERATOR;
+static char andOperator[] = KLI_AND_OPERATOR;
+static char pipeOperator[] = KLI_PIPE_OPERATOR;
+
+// Static prototypes
+
+static char *get_operator(const char *string);
+
 // Implementations
 
 int kli_parse_line(char *line, char **argv) {
     int argc = 0;
-    char *token = strtok(line, " ");
-    while(token != NULL && argc < KLI_MAX_ARGC) {
-        argv[argc++] = token;
-        token = strtok(NULL, " ");
+
+    // Split tokens in place, without strtok hidden state so sessions can parse concurrently
+    while(argc < KLI_MAX_ARGC) {
+        while(*line == ' ')
+            ++line;
+        if(!*line)
+            break;
+
+        // Operator -> its characters terminate the previous token
+        char *operator = get_operator(line);
+        if(operator) {
+            argv[argc++] = operator;
+            size_t length = strlen(operator);
+            memset(line, '\0', length);
+            line += length;
+            continue;
+        }
+
+        // Token ends at a space, an operator or the end of the line
+        argv[argc++] = line;
+        while(*line && *line != ' ' && !get_operator(line))
+            ++line;
+        if(*line == ' ')
+            *line++ = '\0';
     }
     return argc;
 }
@@ -35,3 +65,15 @@ bool kli_parse_float(const char *string, float *value) {
     *value = strtof(string, &end);
     return end != string;
 }
+
+// Static definitions
+
+static char *get_operator(const char *string) {
+    if(!strncmp(string, sequenceOperator, sizeof(sequenceOperator) - 1))
+        return sequenceOperator;
+    if(!strncmp(string, andOperator, sizeof(andOperator) - 1))
+        return andOperator;
+    if(!strncmp(string, pipeOperator, sizeof(pipeOperator) - 1))
+        return pipeOperator;
+    return NULL;
+}
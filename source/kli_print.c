@@ -16,24 +16,36 @@
 
 // Static variables
 
-static char string[KLI_MAX_PRINT_SIZE] = {0};
-static int size = 0;
+static KLI_THREAD_LOCAL KliPrinter defaultPrinter = {0};
+static KLI_THREAD_LOCAL KliPrinter *boundPrinter = NULL;
+static KLI_THREAD_LOCAL unsigned long outputBreaks = 0;
+
+// Static prototypes
+
+static inline KliPrinter *get_printer(void);
 
 // Implementations
 
 void kli_print(const char *format, ...) {
+    KliPrinter * const printer = get_printer();
 
     // Compute space left in the buffer
-    const size_t LEFT_PRINT_SPACE = KLI_MAX_PRINT_SIZE - size;
+    const size_t LEFT_PRINT_SPACE = KLI_MAX_PRINT_SIZE - printer->size;
 
     // Format string
     va_list args;
     va_start(args, format);
-    int formattedLength = vsnprintf(&string[size], LEFT_PRINT_SPACE, format, args);
+    int formattedLength = vsnprintf(&printer->string[printer->size], LEFT_PRINT_SPACE, format, args);
     va_end(args);
 
+    // Held output can't be flushed, keep the truncated string
+    if(formattedLength > LEFT_PRINT_SPACE - 1 && printer->hold) {
+        printer->size = KLI_MAX_PRINT_SIZE - 1;
+        ++outputBreaks;
+    }
+
     // Handle case where KLI_MAX_PRINT_SIZE is reached, display warning
-    if(formattedLength > LEFT_PRINT_SPACE - 1) {
+    else if(formattedLength > LEFT_PRINT_SPACE - 1) {
         kli_flush();
         kli_print("\n\n\t\tWARNING - KLI_MAX_PRINT_SIZE REACHED\n\n");
         kli_flush();
@@ -41,10 +53,93 @@ void kli_print(const char *format, ...) {
 
     // Increment print buffer character count
     else
-        size += strnlen(&string[size], LEFT_PRINT_SPACE - 1);
+        printer->size += strnlen(&printer->string[printer->size], LEFT_PRINT_SPACE - 1);
 }
 
 void kli_flush(void) {
-    kli_out(string, size);
-    size = 0;
+    KliPrinter * const printer = get_printer();
+    if(printer->hold)
+        return;
+    if(printer->out)
+        printer->out(printer->user, printer->string, printer->size);
+    else
+        kli_out(printer->string, printer->size);
+    printer->size = 0;
+    ++outputBreaks;
+}
+
+void kli_write(const char *data, int length) {
+    KliPrinter * const printer = get_printer();
+
+    // Held output -> append what fits, like a truncated print
+    if(printer->hold) {
+        const int left = KLI_MAX_PRINT_SIZE - 1 - printer->size;
+        if(length > left) {
+            length = left;
+            ++outputBreaks;
+        }
+        memcpy(&printer->string[printer->size], data, length);
+        printer->size += length;
+        printer->string[printer->size] = '\0';
+        return;
+    }
+
+    // Keep order with formatted output
+    kli_flush();
+    if(printer->out)
+        printer->out(printer->user, data, length);
+    else
+        kli_out(data, length);
+}
+
+void kli_put(const char *data, int length) {
+    KliPrinter * const printer = get_printer();
+    while(length > 0) {
+
+        // Copy what fits, keeping the string null terminated
+        int left = KLI_MAX_PRINT_SIZE - 1 - printer->size;
+        int count = length < left ? length : left;
+        memcpy(&printer->string[printer->size], data, count);
+        printer->size += count;
+        printer->string[printer->size] = '\0';
+        data += count;
+        length -= count;
+
+        // Full -> flush and go on, held output is truncated instead
+        if(length && printer->hold) {
+            ++outputBreaks;
+            return;
+        }
+        if(length)
+            kli_flush();
+    }
+}
+
+KliPrintMark kli_print_mark(void) {
+    const KliPrinter * const printer = get_printer();
+    return (KliPrintMark){printer, printer->size, outputBreaks};
+}
+
+int kli_print_since(const KliPrintMark *mark, const char **output) {
+    const KliPrinter * const printer = get_printer();
+    if(printer != mark->printer || outputBreaks != mark->breaks || printer->size < mark->size)
+        return -1;
+    *output = &printer->string[mark->size];
+    return printer->size - mark->size;
+}
+
+KliPrinter *kli_print_bind(KliPrinter *printer) {
+    KliPrinter *previous = boundPrinter;
+    boundPrinter = printer;
+    return previous;
+}
+
+KliPrinter *kli_print_bound(void) {
+    return get_printer();
+}
+
+// Static definitions
+
+static inline KliPrinter *get_printer(void) {
+    return boundPrinter ? boundPrinter : &defaultPrinter;
 }
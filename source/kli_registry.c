@@ -0,0 +1,337 @@
+/**
+ * @file kli_registry.c
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI runtime command registry implementation.
+ */
+
+// Includes
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "kli_registry.h"
+#include "kli_config.h"
+
+// Static structures
+
+/**
+ * @brief Slot of the registry index, free if its mount path is NULL.
+ */
+typedef struct Slot {
+
+    // Hash of the mount path, each name followed by a space.
+    uint32_t hash;
+
+    // Number of names of the mount path.
+    int depth;
+
+    // Mounted table.
+    KliMount mount;
+
+} Slot;
+
+/**
+ * @brief Registry version, never written while published.
+ */
+typedef struct Version {
+
+    // Open addressing index, linear probing without tombstones.
+    Slot slots[KLI_REGISTRY_SIZE];
+
+    // Number of used slots.
+    int count;
+
+    // Bit n set if a mount path has n + 1 names, depths without mounts are not probed.
+    unsigned depths;
+
+} Version;
+
+// Static variables
+
+static Version versions[2] = {0};
+static atomic_int currentVersion = 0;
+static atomic_int readers[2] = {0};
+static atomic_flag writing = ATOMIC_FLAG_INIT;
+static KLI_THREAD_LOCAL int readDepth = 0;
+static KLI_THREAD_LOCAL int readVersion = 0;
+static KLI_THREAD_LOCAL KliMount deferred[KLI_REGISTRY_DEFERRED ? KLI_REGISTRY_DEFERRED : 1];
+static KLI_THREAD_LOCAL int deferredCount = 0;
+
+// Static prototypes
+
+/**
+ * @brief Hash a path, or tokens, name by name.
+ * @param hash Hash of the previous names.
+ * @param name Name to add.
+ * @param length Name length.
+ * @return Hash including the name.
+ */
+static inline uint32_t hash_name(uint32_t hash, const char *name, size_t length);
+
+/**
+ * @brief Check a mount path and hash it.
+ * @param path Mount path.
+ * @param hash Path hash return pointer.
+ * @return Number of names, 0 if the path is invalid.
+ */
+static int hash_path(const char *path, uint32_t *hash);
+
+/**
+ * @brief Find the slot of a mount path.
+ * @param version Registry version.
+ * @param path Mount path.
+ * @param hash Path hash.
+ * @return Slot index, -1 if not mounted.
+ */
+static int find_slot(const Version *version, const char *path, uint32_t hash);
+
+/**
+ * @brief Check if a path matches the first tokens.
+ * @param path Mount path.
+ * @param depth Number of tokens to match.
+ * @param argv Tokens.
+ * @return True if each name matches its token, false otherwise.
+ */
+static bool match_path(const char *path, int depth, char **argv);
+
+/**
+ * @brief Check if a table or one of its subtables contains asynchronous handlers.
+ * @param table Command table.
+ * @return True if an asynchronous handler was found, false otherwise.
+ */
+static bool has_async(const KliCommand table[]);
+
+/**
+ * @brief Queue a mount or an unmount until the read section is left.
+ * @param path Mount path.
+ * @param description Description shown by help.
+ * @param table Command table, NULL to unmount.
+ * @return True if queued, false if KLI_REGISTRY_DEFERRED is reached.
+ */
+static bool defer(const char *path, const char *description, const KliCommand table[]);
+
+/**
+ * @brief Lock the writer side and prepare the unpublished version from the published one.
+ * @return Unpublished version.
+ * @note Must not be called from a read section, waiting for our own readers would never end.
+ */
+static Version *begin_write(void);
+
+/**
+ * @brief Publish the prepared version, wait for the readers of the previous one, and unlock the writer side.
+ * @param publish False to drop the prepared version.
+ */
+static void end_write(bool publish);
+
+// Implementations
+
+bool kli_registry_mount(const char *path, const char *description, const KliCommand table[]) {
+    uint32_t hash = 0;
+    const int depth = hash_path(path, &hash);
+    if(!depth || !table || has_async(table))
+        return false;
+
+    // Called from a dispatched command -> mount once it returns
+    if(readDepth)
+        return defer(path, description, table);
+
+    // Keep at least a quarter of the slots free, so probing stays short and ends
+    Version * const version = begin_write();
+    if(find_slot(version, path, hash) >= 0 || (version->count + 1) * 4 > KLI_REGISTRY_SIZE * 3) {
+        end_write(false);
+        return false;
+    }
+
+    // Insert at the first free slot of the probe sequence
+    int i = hash & (KLI_REGISTRY_SIZE - 1);
+    while(version->slots[i].mount.path)
+        i = (i + 1) & (KLI_REGISTRY_SIZE - 1);
+    version->slots[i] = (Slot){hash, depth, {path, description, table}};
+    version->depths |= 1u << (depth - 1);
+    ++version->count;
+    end_write(true);
+    return true;
+}
+
+bool kli_registry_unmount(const char *path) {
+    uint32_t hash = 0;
+    if(!hash_path(path, &hash))
+        return false;
+
+    // Called from a dispatched command -> unmount once it returns
+    if(readDepth)
+        return defer(path, NULL, NULL);
+
+    // Find mount
+    Version * const version = begin_write();
+    int i = find_slot(version, path, hash);
+    if(i < 0) {
+        end_write(false);
+        return false;
+    }
+
+    // Free slot, then shift back following slots which can't be reached across the hole anymore
+    version->slots[i].mount.path = NULL;
+    for(int j = (i + 1) & (KLI_REGISTRY_SIZE - 1); version->slots[j].mount.path; j = (j + 1) & (KLI_REGISTRY_SIZE - 1)) {
+        const int home = version->slots[j].hash & (KLI_REGISTRY_SIZE - 1);
+        const bool reachable = i <= j ? (home > i && home <= j) : (home > i || home <= j);
+        if(reachable)
+            continue;
+        version->slots[i] = version->slots[j];
+        version->slots[j].mount.path = NULL;
+        i = j;
+    }
+
+    // Recompute mounted depths
+    version->depths = 0;
+    for(int j = 0; j < KLI_REGISTRY_SIZE; j++)
+        if(version->slots[j].mount.path)
+            version->depths |= 1u << (version->slots[j].depth - 1);
+    --version->count;
+    end_write(true);
+    return true;
+}
+
+void kli_registry_enter(void) {
+    if(readDepth++)
+        return;
+
+    // Announce the reader on the published version, retry if it was replaced meanwhile
+    for(;;) {
+        const int version = atomic_load(&currentVersion);
+        atomic_fetch_add(&readers[version], 1);
+        if(atomic_load(&currentVersion) == version) {
+            readVersion = version;
+            return;
+        }
+        atomic_fetch_sub(&readers[version], 1);
+    }
+}
+
+void kli_registry_leave(void) {
+    if(--readDepth)
+        return;
+    atomic_fetch_sub(&readers[readVersion], 1);
+
+    // Apply changes deferred inside the section, outside of it
+    for(int i = 0; i < deferredCount; i++)
+        if(deferred[i].table)
+            kli_registry_mount(deferred[i].path, deferred[i].description, deferred[i].table);
+        else
+            kli_registry_unmount(deferred[i].path);
+    deferredCount = 0;
+}
+
+const KliMount *kli_registry_find(int argc, char **argv, int *depth) {
+    const Version * const version = &versions[readVersion];
+    if(!readDepth || !version->count)
+        return NULL;
+
+    // Hash each token prefix once
+    uint32_t hashes[KLI_REGISTRY_DEPTH + 1] = {KLI_FLAT_HASH_BASIS};
+    const int maxDepth = argc < KLI_REGISTRY_DEPTH ? argc : KLI_REGISTRY_DEPTH;
+    for(int i = 0; i < maxDepth; i++)
+        hashes[i + 1] = hash_name(hashes[i], argv[i], strlen(argv[i]));
+
+    // Probe mounted depths only, longest path first
+    for(int d = maxDepth; d > 0; d--) {
+        if(!(version->depths & (1u << (d - 1))))
+            continue;
+        for(int i = hashes[d] & (KLI_REGISTRY_SIZE - 1); version->slots[i].mount.path; i = (i + 1) & (KLI_REGISTRY_SIZE - 1)) {
+            const Slot * const slot = &version->slots[i];
+            if(slot->hash == hashes[d] && slot->depth == d && match_path(slot->mount.path, d, argv)) {
+                *depth = d;
+                return &slot->mount;
+            }
+        }
+    }
+    return NULL;
+}
+
+const KliMount *kli_registry_at(int slot) {
+    if(!readDepth || slot < 0 || slot >= KLI_REGISTRY_SIZE)
+        return NULL;
+    const Slot * const entry = &versions[readVersion].slots[slot];
+    return entry->mount.path ? &entry->mount : NULL;
+}
+
+// Static definitions
+
+static inline uint32_t hash_name(uint32_t hash, const char *name, size_t length) {
+    for(size_t i = 0; i < length; i++)
+        hash = (hash ^ (unsigned char)name[i]) * KLI_FLAT_HASH_PRIME;
+    return (hash ^ ' ') * KLI_FLAT_HASH_PRIME;
+}
+
+static int hash_path(const char *path, uint32_t *hash) {
+    if(!path)
+        return 0;
+
+    // Names must be non empty and separated by single spaces
+    int depth = 0;
+    *hash = KLI_FLAT_HASH_BASIS;
+    for(const char *name = path;; name++) {
+        size_t length = strcspn(name, " ");
+        if(!length || ++depth > KLI_REGISTRY_DEPTH)
+            return 0;
+        *hash = hash_name(*hash, name, length);
+        name += length;
+        if(!*name)
+            return depth;
+    }
+}
+
+static int find_slot(const Version *version, const char *path, uint32_t hash) {
+    for(int i = hash & (KLI_REGISTRY_SIZE - 1); version->slots[i].mount.path; i = (i + 1) & (KLI_REGISTRY_SIZE - 1))
+        if(version->slots[i].hash == hash && !strcmp(version->slots[i].mount.path, path))
+            return i;
+    return -1;
+}
+
+static bool match_path(const char *path, int depth, char **argv) {
+    for(int i = 0; i < depth; i++) {
+        size_t length = strlen(argv[i]);
+        if(strncmp(path, argv[i], length) || (path[length] != ' ' && path[length] != '\0'))
+            return false;
+        path += length + 1;
+    }
+    return true;
+}
+
+static bool has_async(const KliCommand table[]) {
+    for(const KliCommand *entry = table; entry->name; entry++)
+        if((entry->flags & KLI_COMMAND_ASYNC) || (entry->subcommands && has_async(entry->subcommands)))
+            return true;
+    return false;
+}
+
+static bool defer(const char *path, const char *description, const KliCommand table[]) {
+    if(deferredCount >= KLI_REGISTRY_DEFERRED)
+        return false;
+    deferred[deferredCount++] = (KliMount){path, description, table};
+    return true;
+}
+
+static Version *begin_write(void) {
+    while(atomic_flag_test_and_set(&writing))
+        KLI_REGISTRY_YIELD();
+
+    // Readers of the unpublished version were waited for when it was replaced
+    const int current = atomic_load(&currentVersion);
+    versions[!current] = versions[current];
+    return &versions[!current];
+}
+
+static void end_write(bool publish) {
+
+    // Swap versions, then wait until no reader uses the previous one
+    if(publish) {
+        const int previous = atomic_load(&currentVersion);
+        atomic_store(&currentVersion, !previous);
+        while(atomic_load(&readers[previous]))
+            KLI_REGISTRY_YIELD();
+    }
+    atomic_flag_clear(&writing);
+}
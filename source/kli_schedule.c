@@ -0,0 +1,212 @@
+/**
+ * @file kli_schedule.c
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI periodic command scheduling implementation, based on a timer wheel.
+ */
+
+// Includes
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "kli_schedule.h"
+#include "kli_config.h"
+#include "kli_emit.h"
+#include "kli_print.h"
+
+// Static structures
+
+/**
+ * @brief Periodic job, a resolved command linked in a timer wheel slot.
+ */
+typedef struct Job {
+
+    // Resolved command, called without any parsing.
+    KliResolved resolved;
+
+    // Period in ticks.
+    unsigned long period;
+
+    // Full wheel turns left before the job is due.
+    unsigned long rounds;
+
+    // Next job in the same wheel slot, -1 for none.
+    int next;
+
+    // Clear the screen before each call.
+    bool clear;
+
+    // Job slot is in use.
+    bool used;
+
+} Job;
+
+// Static variables
+
+static Job jobs[KLI_MAX_JOBS ? KLI_MAX_JOBS : 1] = {0};
+static int wheel[KLI_WHEEL_SIZE] = {0};
+static int wheelCursor = 0;
+static bool wheelInitialized = false;
+
+// Static prototypes
+
+static void initialize_wheel(void);
+static void insert_job(int id, unsigned long ticks);
+static void remove_job(int id);
+
+// Implementations
+
+int kli_schedule(const KliCommand table[], int argc, char **argv, unsigned long period, bool clear) {
+    initialize_wheel();
+
+    // Find a free job slot
+    int id = 0;
+    while(id < KLI_MAX_JOBS && jobs[id].used)
+        ++id;
+    if(id >= KLI_MAX_JOBS) {
+        if(!kli_emit_error("no free job, KLI_MAX_JOBS reached", NULL))
+            kli_print("\tSchedule - no free job, KLI_MAX_JOBS reached\n\n");
+        return -1;
+    }
+
+    // Resolve command once
+    Job * const job = &jobs[id];
+    const char *error = kli_resolve(table, argc, argv, &job->resolved);
+    if(error) {
+        if(!kli_emit_error(error, argv[0]))
+            kli_print("\t'%s' - %s\n\n", argv[0], error);
+        return -1;
+    }
+
+    // Insert job, first call after one period
+    job->period = (period + KLI_TICK_MS - 1) / KLI_TICK_MS;
+    job->period = job->period ? job->period : 1;
+    job->clear = clear;
+    job->used = true;
+    insert_job(id, job->period);
+    return id;
+}
+
+bool kli_unschedule(int id) {
+    initialize_wheel();
+
+    // Stop all jobs
+    if(id < 0) {
+        bool stopped = false;
+        for(int i = 0; i < KLI_MAX_JOBS; i++)
+            stopped = kli_unschedule(i) || stopped;
+        return stopped;
+    }
+
+    // Stop a single job
+    if(id >= KLI_MAX_JOBS || !jobs[id].used)
+        return false;
+    remove_job(id);
+    jobs[id].used = false;
+    return true;
+}
+
+void kli_schedule_list(void) {
+
+    // Structured output -> one record holding the jobs
+    if(kli_emit_encoding() != KLI_ENCODING_TEXT) {
+        kli_emit_begin_array("jobs");
+        for(int i = 0; i < KLI_MAX_JOBS; i++) {
+            if(!jobs[i].used)
+                continue;
+            kli_emit_begin_object(NULL);
+            kli_emit_u32("job", i);
+            kli_emit_u32("period", jobs[i].period * KLI_TICK_MS);
+            kli_emit_bool("watch", jobs[i].clear);
+            kli_emit_str("command", jobs[i].resolved.line);
+            kli_emit_end_object();
+        }
+        kli_emit_end_array();
+        return;
+    }
+    kli_print("\t[JOB(S)]\n\n");
+    for(int i = 0; i < KLI_MAX_JOBS; i++)
+        if(jobs[i].used)
+            kli_print("\t\t%d - every %lu ms%s - '%s'\n", i, jobs[i].period * KLI_TICK_MS, jobs[i].clear ? " (watch)" : "", jobs[i].resolved.line);
+}
+
+void kli_tick(void) {
+    initialize_wheel();
+
+    // Advance wheel and detach due slot
+    wheelCursor = (wheelCursor + 1) % KLI_WHEEL_SIZE;
+    int id = wheel[wheelCursor];
+    wheel[wheelCursor] = -1;
+
+    // Visit detached jobs
+    bool called = false;
+    while(id >= 0) {
+        Job * const job = &jobs[id];
+        int next = job->next;
+
+        // Stopped while detached -> drop it
+        if(!job->used) {
+            id = next;
+            continue;
+        }
+
+        // Not due yet -> back in the same slot for another turn
+        if(job->rounds) {
+            --job->rounds;
+            job->next = wheel[wheelCursor];
+            wheel[wheelCursor] = id;
+        }
+
+        // Due -> call handler, stop job on error, reschedule otherwise
+        else {
+            called = true;
+            if(job->clear && kli_emit_encoding() == KLI_ENCODING_TEXT)
+                kli_print("\033[2J\033[H");
+            const char *error = kli_invoke(&job->resolved);
+            if(error) {
+                if(!kli_emit_error(error, job->resolved.line))
+                    kli_print("\t'%s' - %s\n\n", job->resolved.line, error);
+                job->used = false;
+            }
+            else if(job->used)
+                insert_job(id, job->period);
+        }
+        id = next;
+    }
+
+    // Flush jobs output
+    if(called)
+        kli_flush();
+}
+
+// Static definitions
+
+static void initialize_wheel(void) {
+    if(wheelInitialized)
+        return;
+    for(int i = 0; i < KLI_WHEEL_SIZE; i++)
+        wheel[i] = -1;
+    wheelInitialized = true;
+}
+
+static void insert_job(int id, unsigned long ticks) {
+
+    // Slot reached after ticks, with extra turns for periods longer than the wheel
+    int slot = (wheelCursor + ticks) % KLI_WHEEL_SIZE;
+    jobs[id].rounds = (ticks - 1) / KLI_WHEEL_SIZE;
+    jobs[id].next = wheel[slot];
+    wheel[slot] = id;
+}
+
+static void remove_job(int id) {
+
+    // Unlink job from its slot
+    for(int slot = 0; slot < KLI_WHEEL_SIZE; slot++) {
+        for(int *link = &wheel[slot]; *link >= 0; link = &jobs[*link].next) {
+            if(*link == id) {
+                *link = jobs[id].next;
+                return;
+            }
+        }
+    }
+}
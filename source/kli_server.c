@@ -0,0 +1,471 @@
+/**
+ * @file kli_server.c
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI multi-session server implementation, based on epoll and a worker pool.
+ */
+
+#ifdef __linux__
+
+// Includes
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <termios.h>
+#include "kli_server.h"
+#include "kli_config.h"
+#include "kli_input.h"
+#include "kli_optargs.h"
+#include "kli_parse.h"
+#include "kli_print.h"
+
+// Static definitions
+
+#define LISTEN_EVENT                KLI_SERVER_MAX_SESSIONS         // Event data of the listening socket.
+#define STOP_EVENT                  (KLI_SERVER_MAX_SESSIONS + 1)   // Event data of the stop event.
+#define MAX_EVENTS                  64                              // Events handled per epoll_wait call.
+#define READ_SIZE                   512                             // Bytes read per read call.
+#define LINE_TOO_LONG               "\tLine too long, KLI_MAX_LINE_SIZE reached\n\n" KLI_SERVER_PROMPT
+
+// Static structures
+
+/**
+ * @brief Server session, a client connection or a pseudo terminal with its own state.
+ */
+typedef struct Session {
+
+    // Client file descriptor, -1 if the session is free.
+    int fd;
+
+    // Pseudo terminal slave file descriptor, -1 for sockets.
+    int slave;
+
+    // Output buffer of the session handlers.
+    KliPrinter printer;
+
+    // Options and arguments of the session handlers.
+    KliOptargs optargs;
+
+    // Line editor of pseudo terminals, with completion and history.
+    KliInput editor;
+
+    // Line being received from sockets.
+    char input[KLI_MAX_LINE_SIZE];
+
+    // Character count of the line being received.
+    size_t inputSize;
+
+    // Line being received is too long, skip it up to its end.
+    bool discarding;
+
+    // Last character received was a carriage return.
+    bool carriageReturn;
+
+    // Output not yet written to the client.
+    char output[KLI_SERVER_OUTPUT_SIZE];
+
+    // Offset of the first output byte not yet written.
+    size_t outputStart;
+
+    // Count of output bytes not yet written.
+    size_t outputSize;
+
+} Session;
+
+// Static variables
+
+static Session sessions[KLI_SERVER_MAX_SESSIONS] = {0};
+static pthread_mutex_t sessionsLock = PTHREAD_MUTEX_INITIALIZER;
+static const KliCommand *serverTable = NULL;
+static int epollFd = -1;
+static int listenFd = -1;
+static int stopFd = -1;
+static int workerCount = 0;
+static pthread_t workers[KLI_SERVER_MAX_WORKERS];
+static int queue[KLI_SERVER_MAX_SESSIONS] = {0};
+static int queueStart = 0;
+static int queueSize = 0;
+static bool stopping = false;
+static pthread_mutex_t queueLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queueReady = PTHREAD_COND_INITIALIZER;
+
+// Static prototypes
+
+static bool open_session(int fd, int slave);
+static void close_session(Session *session);
+static void arm_session(Session *session);
+static void service_session(Session *session);
+static void run_line(Session *session);
+static void split_lines(Session *session, const char *data, int length);
+static void edit_input(Session *session, const char *data, int length);
+static bool write_output(Session *session);
+static void session_out(void *user, const char *string, int length);
+static void accept_clients(void);
+static void queue_session(int index);
+static void *worker_main(void *unused);
+
+// Implementations
+
+bool kli_server_start(const KliCommand table[], const char *path, int workers) {
+
+    // Workers share library state unless it is thread local
+    if(workers > 0 && !KLI_THREADED) {
+        errno = EINVAL;
+        return false;
+    }
+    serverTable = table;
+    workerCount = workers < 0 ? 0 : workers > KLI_SERVER_MAX_WORKERS ? KLI_SERVER_MAX_WORKERS : workers;
+    for(int i = 0; i < KLI_SERVER_MAX_SESSIONS; i++)
+        sessions[i].fd = sessions[i].slave = -1;
+
+    // Event loop and stop event
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(epollFd < 0 || stopFd < 0)
+        return false;
+    struct epoll_event event = {.events = EPOLLIN, .data.u32 = STOP_EVENT};
+    if(epoll_ctl(epollFd, EPOLL_CTL_ADD, stopFd, &event))
+        return false;
+
+    // PTY only server
+    if(!path)
+        return true;
+
+    // Unix domain socket, replacing a previous one
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if(strlen(path) >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    strcpy(address.sun_path, path);
+    unlink(path);
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(listenFd < 0 || bind(listenFd, (struct sockaddr *)&address, sizeof(address)) || listen(listenFd, SOMAXCONN))
+        return false;
+    event.data.u32 = LISTEN_EVENT;
+    return !epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+}
+
+bool kli_server_open_pty(char *name, size_t size) {
+
+    // Open master, then keep the slave open so the master doesn't hang up between clients
+    int master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if(master < 0)
+        return false;
+    int slave = -1;
+    if(!grantpt(master) && !unlockpt(master) && !ptsname_r(master, name, size))
+        slave = open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+
+    // Raw line discipline, so the output isn't echoed back as input
+    struct termios attributes;
+    bool raw = slave >= 0 && !tcgetattr(slave, &attributes);
+    if(raw) {
+        cfmakeraw(&attributes);
+        raw = !tcsetattr(slave, TCSANOW, &attributes);
+    }
+    if(!raw || !open_session(master, slave)) {
+        if(slave >= 0)
+            close(slave);
+        close(master);
+        return false;
+    }
+    return true;
+}
+
+void kli_server_run(void) {
+    struct epoll_event events[MAX_EVENTS];
+
+    // Start workers
+    stopping = false;
+    int started = 0;
+    while(started < workerCount && !pthread_create(&workers[started], NULL, worker_main, NULL))
+        ++started;
+    workerCount = started;
+
+    // Wait for events until stopped
+    bool running = true;
+    while(running) {
+        int count = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        if(count < 0 && errno != EINTR)
+            break;
+        for(int i = 0; i < count; i++) {
+            uint32_t data = events[i].data.u32;
+            if(data == STOP_EVENT)
+                running = false;
+            else if(data == LISTEN_EVENT)
+                accept_clients();
+            else if(workerCount)
+                queue_session(data);
+            else
+                service_session(&sessions[data]);
+        }
+    }
+
+    // Stop workers
+    pthread_mutex_lock(&queueLock);
+    stopping = true;
+    pthread_cond_broadcast(&queueReady);
+    pthread_mutex_unlock(&queueLock);
+    for(int i = 0; i < workerCount; i++)
+        pthread_join(workers[i], NULL);
+
+    // Close sessions, listening socket and event loop
+    for(int i = 0; i < KLI_SERVER_MAX_SESSIONS; i++)
+        if(sessions[i].fd >= 0)
+            close_session(&sessions[i]);
+    if(listenFd >= 0)
+        close(listenFd);
+    close(stopFd);
+    close(epollFd);
+    listenFd = stopFd = epollFd = -1;
+}
+
+void kli_server_stop(void) {
+    uint64_t one = 1;
+    if(write(stopFd, &one, sizeof(one)) < 0)
+        return;
+}
+
+// Static definitions
+
+static bool open_session(int fd, int slave) {
+
+    // Find a free session
+    pthread_mutex_lock(&sessionsLock);
+    int index = 0;
+    while(index < KLI_SERVER_MAX_SESSIONS && sessions[index].fd >= 0)
+        ++index;
+    if(index < KLI_SERVER_MAX_SESSIONS)
+        sessions[index].fd = fd;
+    pthread_mutex_unlock(&sessionsLock);
+    if(index >= KLI_SERVER_MAX_SESSIONS)
+        return false;
+
+    // Reset session state
+    Session * const session = &sessions[index];
+    session->slave = slave;
+    session->printer.size = 0;
+    session->printer.out = session_out;
+    session->printer.user = session;
+    session->printer.hold = false;
+    session->inputSize = 0;
+    session->discarding = false;
+    session->carriageReturn = false;
+    kli_input_init(&session->editor, serverTable, KLI_SERVER_PROMPT);
+    session->editor.interrupt = NULL;
+    session->outputStart = 0;
+    session->outputSize = 0;
+
+    // Greet with a prompt, then wait for input
+    session_out(session, KLI_SERVER_PROMPT, sizeof(KLI_SERVER_PROMPT) - 1);
+    struct epoll_event event = {.events = EPOLLOUT | EPOLLONESHOT, .data.u32 = index};
+    if(epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event)) {
+        pthread_mutex_lock(&sessionsLock);
+        session->fd = -1;
+        pthread_mutex_unlock(&sessionsLock);
+        return false;
+    }
+    return true;
+}
+
+static void close_session(Session *session) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, session->fd, NULL);
+    close(session->fd);
+    if(session->slave >= 0)
+        close(session->slave);
+    pthread_mutex_lock(&sessionsLock);
+    session->fd = session->slave = -1;
+    pthread_mutex_unlock(&sessionsLock);
+}
+
+static void arm_session(Session *session) {
+
+    // Wait for the client to read pending output before reading its next lines
+    struct epoll_event event = {.events = EPOLLONESHOT, .data.u32 = session - sessions};
+    event.events |= session->outputSize ? EPOLLOUT : EPOLLIN;
+    if(epoll_ctl(epollFd, EPOLL_CTL_MOD, session->fd, &event))
+        close_session(session);
+}
+
+static void service_session(Session *session) {
+    char buffer[READ_SIZE];
+
+    // Write pending output first
+    if(!write_output(session)) {
+        close_session(session);
+        return;
+    }
+
+    // Read until no more input, or until output is pending
+    while(!session->outputSize) {
+        ssize_t length = read(session->fd, buffer, sizeof(buffer));
+        if(length < 0 && errno == EINTR)
+            continue;
+        if(length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if(length <= 0) {
+            close_session(session);
+            return;
+        }
+
+        // Pseudo terminals are interactive, edit their lines, sockets send whole lines
+        if(session->slave >= 0)
+            edit_input(session, buffer, length);
+        else
+            split_lines(session, buffer, length);
+
+        // Client closed while output was written
+        if(!write_output(session)) {
+            close_session(session);
+            return;
+        }
+    }
+    arm_session(session);
+}
+
+static void run_line(Session *session) {
+    char *argv[KLI_MAX_ARGC];
+
+    // Dispatch with the session printer and context, nothing resumes background commands
+    KliPrinter *previousPrinter = kli_print_bind(&session->printer);
+    KliOptargs *previousOptargs = kli_optargs_bind(&session->optargs);
+    bool previousBackground = kli_dispatch_background(false);
+    int argc = kli_parse_line(session->input, argv);
+    kli_dispatch(serverTable, argc, argv);
+    kli_print(KLI_SERVER_PROMPT);
+    kli_flush();
+    kli_dispatch_background(previousBackground);
+    kli_optargs_bind(previousOptargs);
+    kli_print_bind(previousPrinter);
+}
+
+static void split_lines(Session *session, const char *data, int length) {
+
+    // Split lines ended by '\r', '\n' or "\r\n"
+    for(int i = 0; i < length; i++) {
+        char c = data[i];
+        bool lineFeedAfterReturn = c == '\n' && session->carriageReturn;
+        session->carriageReturn = c == '\r';
+        if(lineFeedAfterReturn)
+            continue;
+        if(c == '\r' || c == '\n') {
+            session->input[session->inputSize] = '\0';
+            if(session->discarding)
+                session_out(session, LINE_TOO_LONG, sizeof(LINE_TOO_LONG) - 1);
+            else
+                run_line(session);
+            session->inputSize = 0;
+            session->discarding = false;
+        }
+        else if(session->inputSize < KLI_MAX_LINE_SIZE - 1)
+            session->input[session->inputSize++] = c;
+        else
+            session->discarding = true;
+    }
+}
+
+static void edit_input(Session *session, const char *data, int length) {
+
+    // Edit and dispatch with the session printer and context, nothing resumes background commands
+    KliPrinter *previousPrinter = kli_print_bind(&session->printer);
+    KliOptargs *previousOptargs = kli_optargs_bind(&session->optargs);
+    bool previousBackground = kli_dispatch_background(false);
+    kli_input_feed(&session->editor, data, length);
+    kli_dispatch_background(previousBackground);
+    kli_optargs_bind(previousOptargs);
+    kli_print_bind(previousPrinter);
+}
+
+static bool write_output(Session *session) {
+
+    // Write as much as the client accepts without blocking
+    while(session->outputSize) {
+        const char *start = &session->output[session->outputStart];
+        ssize_t length = session->slave >= 0 ? write(session->fd, start, session->outputSize) : send(session->fd, start, session->outputSize, MSG_NOSIGNAL);
+        if(length < 0 && errno == EINTR)
+            continue;
+        if(length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return true;
+        if(length < 0)
+            return false;
+        session->outputStart += length;
+        session->outputSize -= length;
+    }
+    session->outputStart = 0;
+    return true;
+}
+
+static void session_out(void *user, const char *string, int length) {
+    Session * const session = user;
+
+    // Doesn't fit -> try to write pending output first, errors are seen by the next write
+    if(session->outputSize + length > KLI_SERVER_OUTPUT_SIZE)
+        write_output(session);
+
+    // Move pending output to the front if it doesn't fit after it
+    if(session->outputStart + session->outputSize + length > KLI_SERVER_OUTPUT_SIZE) {
+        memmove(session->output, &session->output[session->outputStart], session->outputSize);
+        session->outputStart = 0;
+    }
+
+    // Output beyond KLI_SERVER_OUTPUT_SIZE is dropped
+    size_t left = KLI_SERVER_OUTPUT_SIZE - session->outputSize;
+    size_t copied = (size_t)length < left ? (size_t)length : left;
+    memcpy(&session->output[session->outputStart + session->outputSize], string, copied);
+    session->outputSize += copied;
+}
+
+static void accept_clients(void) {
+
+    // Accept pending clients, refuse them once all sessions are used
+    for(;;) {
+        int fd = accept4(listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0 && errno == EINTR)
+            continue;
+        if(fd < 0)
+            return;
+        if(!open_session(fd, -1))
+            close(fd);
+    }
+}
+
+static void queue_session(int index) {
+
+    // A session is queued at most once, as its events are one shot
+    pthread_mutex_lock(&queueLock);
+    queue[(queueStart + queueSize++) % KLI_SERVER_MAX_SESSIONS] = index;
+    pthread_cond_signal(&queueReady);
+    pthread_mutex_unlock(&queueLock);
+}
+
+static void *worker_main(void *unused) {
+    (void)unused;
+
+    // Service queued sessions until stopped
+    for(;;) {
+        pthread_mutex_lock(&queueLock);
+        while(!queueSize && !stopping)
+            pthread_cond_wait(&queueReady, &queueLock);
+        if(stopping) {
+            pthread_mutex_unlock(&queueLock);
+            return NULL;
+        }
+        int index = queue[queueStart];
+        queueStart = (queueStart + 1) % KLI_SERVER_MAX_SESSIONS;
+        --queueSize;
+        pthread_mutex_unlock(&queueLock);
+        service_session(&sessions[index]);
+    }
+}
+
+#endif /* __linux__ */
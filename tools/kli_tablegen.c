@@ -0,0 +1,1068 @@
+/**
+ * @file kli_tablegen.c
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI table compiler, host program generating sources from KLI table declarations.
+ * @note Build with any host compiler, e.g. 'cc -O2 -o kli_tablegen tools/kli_tablegen.c'.
+ * @note Usage : 'kli_tablegen flat <top level table> <output.c> <source files...>'.
+ * @note Usage : 'kli_tablegen ids <top level table> <output.h> <source files...>', binary frame identifiers and typed encoders.
+ * @note Usage : 'kli_tablegen help <top level table> <output.c> <source files...>', help blob for KLI_HELP_SECTION.
+ *       Mode 'help-compressed' packs descriptions with byte pair encoding. Built-in help is kept if kli_dispatch.c is given.
+ * @note Table macros are read directly from the sources, without preprocessing. Names and descriptions must be string literals.
+ * @note X-macro lists of KLI_DEFINE_OPTION_TABLE and KLI_DEFINE_ARGUMENT_TABLE are expanded, they must be defined in one of the sources.
+ */
+
+// Includes
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+
+// Definitions
+
+#define TABLEGEN_MAX_TABLES             512     // Maximum number of tables read from sources.
+#define TABLEGEN_MAX_ROWS               4096    // Maximum number of rows over all tables.
+#define TABLEGEN_MAX_FIELDS             6       // Maximum number of macro parameters.
+#define TABLEGEN_MAX_TOKEN              1024    // Maximum length of a single token.
+#define TABLEGEN_MAX_ENTRIES            65535   // Maximum number of flattened entries, limited by KliFlatEntry.
+#define TABLEGEN_MAX_NAMES              65535   // Maximum size of the flattened names pool, limited by KliFlatEntry.
+#define TABLEGEN_MAX_IDS                4096    // Maximum number of handlers given a binary frame identifier.
+#define TABLEGEN_ID_BASIS               2166136261u     // FNV-1a basis, must match kli_command_id.
+#define TABLEGEN_ID_PRIME               16777619u       // FNV-1a prime, must match kli_command_id.
+#define TABLEGEN_MAX_LISTS              512     // Maximum number of X-macro lists read from sources.
+#define TABLEGEN_MAX_HELP               4096    // Maximum number of descriptions in a help blob.
+#define TABLEGEN_HELP_DEPTH             15      // Maximum nesting of pair codes, must fit the default KLI_HELP_STACK_SIZE.
+
+// Structures
+
+/**
+ * @brief Kind of table declared in sources.
+ */
+typedef enum TableKind {
+    TABLE_COMMAND,
+    TABLE_OPTION,
+    TABLE_ARGUMENT,
+} TableKind;
+
+/**
+ * @brief Single table row, one per KLI_ADD_* macro.
+ */
+typedef struct Row {
+
+    // Macro name, e.g. KLI_ADD_COMMAND_HANDLER.
+    const char *macro;
+
+    // Decoded string literals or raw tokens, one per macro parameter.
+    char *fields[TABLEGEN_MAX_FIELDS];
+
+    // Number of decoded fields.
+    int count;
+
+} Row;
+
+/**
+ * @brief Table declared in sources, one per KLI_BEGIN_* macro.
+ */
+typedef struct Table {
+
+    // Kind of the table.
+    TableKind kind;
+
+    // Symbol name of the table.
+    char *name;
+
+    // Index of the first row.
+    int first;
+
+    // Number of rows.
+    int count;
+
+} Table;
+
+/**
+ * @brief X-macro list, a function-like macro with a single parameter, e.g. '#define MOVE_OPTIONS(X)'.
+ */
+typedef struct List {
+
+    // Macro name.
+    char *name;
+
+    // Parameter name, called once per row.
+    char *parameter;
+
+    // Macro body, line continuations removed.
+    char *body;
+
+} List;
+
+/**
+ * @brief Source reader state.
+ */
+typedef struct Reader {
+
+    // Whole source file content.
+    char *text;
+
+    // Current reading position.
+    char *cursor;
+
+    // Source file path for error messages.
+    const char *path;
+
+} Reader;
+
+/**
+ * @brief Flattened entry, referencing a source row.
+ */
+typedef struct FlatEntry {
+
+    // Table holding the source row.
+    const Table *table;
+
+    // Index of the row in its table.
+    int index;
+
+    // Offset of the name in the names pool.
+    int name;
+
+    // Index of the children span, -1 if none.
+    int span;
+
+} FlatEntry;
+
+/**
+ * @brief Description of a help blob.
+ */
+typedef struct HelpEntry {
+
+    // Help key, hash of the key string.
+    unsigned long key;
+
+    // Key string, path followed by the option or argument name.
+    char *path;
+
+    // Index of the description, identical descriptions share one.
+    int text;
+
+} HelpEntry;
+
+// Static variables
+
+static Table tables[TABLEGEN_MAX_TABLES] = {0};
+static int tableCount = 0;
+static Row rows[TABLEGEN_MAX_ROWS] = {0};
+static int rowCount = 0;
+static List lists[TABLEGEN_MAX_LISTS] = {0};
+static int listCount = 0;
+static HelpEntry helpEntries[TABLEGEN_MAX_HELP] = {0};
+static int helpCount = 0;
+static unsigned char *helpTexts[TABLEGEN_MAX_HELP] = {0};
+static int helpLengths[TABLEGEN_MAX_HELP] = {0};
+static int helpTextCount = 0;
+
+// Static prototypes
+
+static void fail(const char *format, const char *detail);
+static char *read_file(const char *path);
+static void skip_blanks(Reader *reader);
+static bool read_token(Reader *reader, char *token, bool *isString);
+static bool expect(Reader *reader, const char *expected);
+static void read_sources(int count, char **paths);
+static void read_source(const char *path);
+static void read_lists(const char *path);
+static void read_row(Reader *reader, const char *macro, int expected);
+static void read_list_table(Reader *reader, TableKind kind);
+static char *read_identifier(char **cursor);
+static const Table *find_table(const char *name, TableKind kind);
+static const char *row_name(const Table *table, int index);
+static const Table *row_subcommands(const Table *table, int index);
+static int generate_flat(const char *root, const char *output);
+static int generate_ids(const char *root, const char *output);
+static void emit_ids(FILE *file, const Table *table, const char *path, const char *symbol);
+static void emit_encoders(FILE *file, const char *symbol, const Row *handler);
+static const char *type_of(const char *type, const char **encoder);
+static void append_symbol(char *symbol, const char *name);
+static int generate_help(const char *root, const char *output, bool compressed);
+static void collect_help(const Table *table, const char *path);
+static void add_help(const char *path, const char *separator, const char *name, const char *description);
+static int compress_help(unsigned char pairs[][2], int *first, int *depth);
+static void emit_string(FILE *file, const char *string);
+
+// Implementations
+
+int main(int argc, char **argv) {
+
+    // Check usage
+    if(argc >= 5 && !strcmp(argv[1], "flat")) {
+        read_sources(argc - 4, &argv[4]);
+        return generate_flat(argv[2], argv[3]);
+    }
+    if(argc >= 5 && !strcmp(argv[1], "ids")) {
+        read_sources(argc - 4, &argv[4]);
+        return generate_ids(argv[2], argv[3]);
+    }
+    if(argc >= 5 && (!strcmp(argv[1], "help") || !strcmp(argv[1], "help-compressed"))) {
+        read_sources(argc - 4, &argv[4]);
+        return generate_help(argv[2], argv[3], !strcmp(argv[1], "help-compressed"));
+    }
+
+    // Unknown mode
+    fprintf(stderr, "usage : %s flat <top level table> <output.c> <source files...>\n", argv[0]);
+    fprintf(stderr, "        %s ids <top level table> <output.h> <source files...>\n", argv[0]);
+    fprintf(stderr, "        %s help|help-compressed <top level table> <output.c> <source files...>\n", argv[0]);
+    return EXIT_FAILURE;
+}
+
+// Static definitions
+
+static void fail(const char *format, const char *detail) {
+    fprintf(stderr, "kli_tablegen : ");
+    fprintf(stderr, format, detail);
+    fprintf(stderr, "\n");
+    exit(EXIT_FAILURE);
+}
+
+static char *read_file(const char *path) {
+
+    // Open source file
+    FILE *file = fopen(path, "rb");
+    if(!file)
+        fail("cannot open '%s'", path);
+
+    // Read whole content
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *text = calloc(size + 1, 1);
+    if(!text || fread(text, 1, size, file) != (size_t)size)
+        fail("cannot read '%s'", path);
+    fclose(file);
+    return text;
+}
+
+static void skip_blanks(Reader *reader) {
+    while(*reader->cursor) {
+
+        // Skip whitespaces
+        if(isspace((unsigned char)*reader->cursor))
+            ++reader->cursor;
+
+        // Skip line comments and preprocessor directives
+        else if((reader->cursor[0] == '/' && reader->cursor[1] == '/') || reader->cursor[0] == '#') {
+            while(*reader->cursor && *reader->cursor != '\n') {
+                if(reader->cursor[0] == '\\' && reader->cursor[1] == '\n')
+                    ++reader->cursor;
+                ++reader->cursor;
+            }
+        }
+
+        // Skip block comments
+        else if(reader->cursor[0] == '/' && reader->cursor[1] == '*') {
+            char *end = strstr(&reader->cursor[2], "*/");
+            reader->cursor = end ? &end[2] : &reader->cursor[strlen(reader->cursor)];
+        }
+
+        // Meaningful character
+        else
+            break;
+    }
+}
+
+static bool read_token(Reader *reader, char *token, bool *isString) {
+    size_t length = 0;
+    *isString = false;
+    skip_blanks(reader);
+
+    // End of file
+    if(!*reader->cursor)
+        return false;
+
+    // String literals, adjacent literals are concatenated and escapes are decoded
+    if(*reader->cursor == '"') {
+        *isString = true;
+        while(*reader->cursor == '"') {
+            ++reader->cursor;
+            while(*reader->cursor && *reader->cursor != '"') {
+                char c = *reader->cursor++;
+                if(c == '\\') {
+                    c = *reader->cursor++;
+                    if(c == 'n') c = '\n';
+                    else if(c == 't') c = '\t';
+                    else if(c == 'r') c = '\r';
+                    else if(c == '0') c = '\0';
+                }
+                if(length < TABLEGEN_MAX_TOKEN - 1)
+                    token[length++] = c;
+            }
+            if(*reader->cursor)
+                ++reader->cursor;
+            skip_blanks(reader);
+        }
+    }
+
+    // Character literals, kept as written
+    else if(*reader->cursor == '\'') {
+        do {
+            if(*reader->cursor == '\\' && length < TABLEGEN_MAX_TOKEN - 1)
+                token[length++] = *reader->cursor++;
+            if(length < TABLEGEN_MAX_TOKEN - 1)
+                token[length++] = *reader->cursor++;
+        } while(*reader->cursor && *reader->cursor != '\'');
+        if(*reader->cursor)
+            token[length++] = *reader->cursor++;
+    }
+
+    // Identifiers and numbers
+    else if(isalnum((unsigned char)*reader->cursor) || *reader->cursor == '_') {
+        while((isalnum((unsigned char)*reader->cursor) || *reader->cursor == '_') && length < TABLEGEN_MAX_TOKEN - 1)
+            token[length++] = *reader->cursor++;
+    }
+
+    // Punctuation
+    else
+        token[length++] = *reader->cursor++;
+
+    // Terminate token
+    token[length] = '\0';
+    return true;
+}
+
+static bool expect(Reader *reader, const char *expected) {
+    char token[TABLEGEN_MAX_TOKEN] = {0};
+    bool isString = false;
+    return read_token(reader, token, &isString) && !isString && !strcmp(token, expected);
+}
+
+static void read_sources(int count, char **paths) {
+
+    // Collect X-macro lists first, they can be defined after their table or in another source
+    for(int i = 0; i < count; i++)
+        read_lists(paths[i]);
+    for(int i = 0; i < count; i++)
+        read_source(paths[i]);
+}
+
+static void read_source(const char *path) {
+    Reader reader = {read_file(path), NULL, path};
+    reader.cursor = reader.text;
+    char token[TABLEGEN_MAX_TOKEN] = {0};
+    bool isString = false;
+    Table *table = NULL;
+
+    while(read_token(&reader, token, &isString)) {
+        if(isString)
+            continue;
+
+        // Table declaration
+        TableKind kind = TABLE_COMMAND;
+        bool begin = false;
+        if(!strcmp(token, "KLI_BEGIN_COMMAND_TABLE"))
+            begin = true, kind = TABLE_COMMAND;
+        else if(!strcmp(token, "KLI_BEGIN_OPTION_TABLE"))
+            begin = true, kind = TABLE_OPTION;
+        else if(!strcmp(token, "KLI_BEGIN_ARGUMENT_TABLE"))
+            begin = true, kind = TABLE_ARGUMENT;
+        if(begin) {
+            if(tableCount >= TABLEGEN_MAX_TABLES)
+                fail("too many tables in '%s'", path);
+            if(!expect(&reader, "(") || !read_token(&reader, token, &isString) || !expect(&reader, ")"))
+                fail("malformed table declaration in '%s'", path);
+            table = &tables[tableCount++];
+            table->kind = kind;
+            table->name = strdup(token);
+            table->first = rowCount;
+            table->count = 0;
+        }
+
+        // Table rows
+        else if(!strcmp(token, "KLI_ADD_SUBCOMMAND_TABLE") && table)
+            read_row(&reader, "KLI_ADD_SUBCOMMAND_TABLE", 3), ++table->count;
+        else if(!strcmp(token, "KLI_ADD_COMMAND_HANDLER") && table)
+            read_row(&reader, "KLI_ADD_COMMAND_HANDLER", 5), ++table->count;
+        else if(!strcmp(token, "KLI_ADD_CACHEABLE_COMMAND_HANDLER") && table)
+            read_row(&reader, "KLI_ADD_CACHEABLE_COMMAND_HANDLER", 5), ++table->count;
+        else if(!strcmp(token, "KLI_ADD_ASYNC_COMMAND_HANDLER") && table)
+            read_row(&reader, "KLI_ADD_ASYNC_COMMAND_HANDLER", 5), ++table->count;
+        else if(!strcmp(token, "KLI_ADD_RAW_COMMAND_HANDLER") && table)
+            read_row(&reader, "KLI_ADD_RAW_COMMAND_HANDLER", 4), ++table->count;
+        else if(!strcmp(token, "KLI_ADD_OPTION") && table)
+            read_row(&reader, "KLI_ADD_OPTION", 4), ++table->count;
+        else if(!strcmp(token, "KLI_ADD_TYPED_OPTION") && table)
+            read_row(&reader, "KLI_ADD_TYPED_OPTION", 5), ++table->count;
+        else if(!strcmp(token, "KLI_ADD_ARGUMENT") && table)
+            read_row(&reader, "KLI_ADD_ARGUMENT", 2), ++table->count;
+        else if(!strcmp(token, "KLI_ADD_TYPED_ARGUMENT") && table)
+            read_row(&reader, "KLI_ADD_TYPED_ARGUMENT", 3), ++table->count;
+
+        // Tables declared from X-macro lists, complete in a single macro
+        else if(!strcmp(token, "KLI_DEFINE_OPTION_TABLE"))
+            read_list_table(&reader, TABLE_OPTION), table = NULL;
+        else if(!strcmp(token, "KLI_DEFINE_ARGUMENT_TABLE"))
+            read_list_table(&reader, TABLE_ARGUMENT), table = NULL;
+
+        // Table end
+        else if(!strncmp(token, "KLI_END_", 8))
+            table = NULL;
+    }
+    free(reader.text);
+}
+
+static void read_lists(const char *path) {
+    char *text = read_file(path);
+
+    // Find '#define NAME(PARAMETER)' at line starts
+    for(char *line = text; line; line = strchr(line, '\n'), line = line ? line + 1 : NULL) {
+        char *cursor = line;
+        while(*cursor == ' ' || *cursor == '\t')
+            ++cursor;
+        if(*cursor++ != '#')
+            continue;
+        while(*cursor == ' ' || *cursor == '\t')
+            ++cursor;
+        if(strncmp(cursor, "define", 6) || !isspace((unsigned char)cursor[6]))
+            continue;
+        cursor += 6;
+        while(*cursor == ' ' || *cursor == '\t')
+            ++cursor;
+        char *name = read_identifier(&cursor);
+        if(!name || *cursor++ != '(') {
+            free(name);
+            continue;
+        }
+        char *parameter = read_identifier(&cursor);
+        if(!parameter || *cursor++ != ')') {
+            free(name);
+            free(parameter);
+            continue;
+        }
+
+        // Copy body up to the end of the directive, continuations become spaces
+        char *body = calloc(strlen(cursor) + 1, 1);
+        if(!body)
+            fail("cannot read '%s'", path);
+        size_t length = 0;
+        for(; *cursor && *cursor != '\n'; cursor++) {
+            if(cursor[0] == '\\' && (cursor[1] == '\n' || (cursor[1] == '\r' && cursor[2] == '\n'))) {
+                cursor += cursor[1] == '\r' ? 2 : 1;
+                body[length++] = ' ';
+            }
+            else
+                body[length++] = *cursor;
+        }
+        if(listCount >= TABLEGEN_MAX_LISTS)
+            fail("too many X-macro lists in '%s'", path);
+        lists[listCount++] = (List){name, parameter, body};
+        line = cursor;
+    }
+    free(text);
+}
+
+static void read_row(Reader *reader, const char *macro, int expected) {
+    char token[TABLEGEN_MAX_TOKEN] = {0};
+    char field[TABLEGEN_MAX_TOKEN] = {0};
+    bool isString = false;
+    int depth = 0;
+
+    // Check row capacity
+    if(rowCount >= TABLEGEN_MAX_ROWS)
+        fail("too many rows in '%s'", reader->path);
+    Row *row = &rows[rowCount++];
+    row->macro = macro;
+
+    // Read parameters separated by top level commas
+    if(!expect(reader, "("))
+        fail("malformed row in '%s'", reader->path);
+    while(read_token(reader, token, &isString)) {
+        bool separator = !isString && !depth && (!strcmp(token, ",") || !strcmp(token, ")"));
+        if(separator) {
+            if(row->count < TABLEGEN_MAX_FIELDS)
+                row->fields[row->count++] = strdup(field);
+            field[0] = '\0';
+            if(!strcmp(token, ")"))
+                break;
+            continue;
+        }
+        if(!isString && !strcmp(token, "("))
+            ++depth;
+        if(!isString && !strcmp(token, ")"))
+            --depth;
+        if(field[0] && !isString)
+            strncat(field, " ", TABLEGEN_MAX_TOKEN - strlen(field) - 1);
+        strncat(field, token, TABLEGEN_MAX_TOKEN - strlen(field) - 1);
+    }
+
+    // Ensure parameter count
+    if(row->count != expected)
+        fail("unexpected parameter count for %s", macro);
+}
+
+static void read_list_table(Reader *reader, TableKind kind) {
+    char name[TABLEGEN_MAX_TOKEN] = {0};
+    char list[TABLEGEN_MAX_TOKEN] = {0};
+    bool isString = false;
+
+    // Read 'KLI_DEFINE_*_TABLE(name, list)'
+    if(!expect(reader, "(") || !read_token(reader, name, &isString) || !expect(reader, ",") ||
+       !read_token(reader, list, &isString) || !expect(reader, ")"))
+        fail("malformed X-macro table declaration in '%s'", reader->path);
+    const List *found = NULL;
+    for(int i = 0; i < listCount && !found; i++)
+        if(!strcmp(lists[i].name, list))
+            found = &lists[i];
+    if(!found)
+        fail("X-macro list '%s' not found, it must be defined in one of the sources", list);
+
+    // Declare table
+    if(tableCount >= TABLEGEN_MAX_TABLES)
+        fail("too many tables in '%s'", reader->path);
+    Table *table = &tables[tableCount++];
+    table->kind = kind;
+    table->name = strdup(name);
+    table->first = rowCount;
+    table->count = 0;
+
+    // Each call of the parameter is a row, its leading identifier is dropped
+    const char *macro = kind == TABLE_OPTION ? "KLI_ADD_OPTION" : "KLI_ADD_ARGUMENT";
+    Reader body = {found->body, found->body, reader->path};
+    char token[TABLEGEN_MAX_TOKEN] = {0};
+    while(read_token(&body, token, &isString)) {
+        if(isString || strcmp(token, found->parameter))
+            continue;
+        read_row(&body, macro, kind == TABLE_OPTION ? 5 : 3);
+        Row *row = &rows[rowCount - 1];
+        free(row->fields[0]);
+        memmove(&row->fields[0], &row->fields[1], (row->count - 1) * sizeof(row->fields[0]));
+        row->fields[--row->count] = NULL;
+        ++table->count;
+    }
+}
+
+static char *read_identifier(char **cursor) {
+    const char *start = *cursor;
+    while(isalnum((unsigned char)**cursor) || **cursor == '_')
+        ++*cursor;
+    if(*cursor == start || isdigit((unsigned char)*start))
+        return NULL;
+    return strndup(start, *cursor - start);
+}
+
+static const Table *find_table(const char *name, TableKind kind) {
+    for(int i = 0; i < tableCount; i++)
+        if(tables[i].kind == kind && !strcmp(tables[i].name, name))
+            return &tables[i];
+    return NULL;
+}
+
+static const char *row_name(const Table *table, int index) {
+    return rows[table->first + index].fields[0];
+}
+
+static const Table *row_subcommands(const Table *table, int index) {
+    const Row *row = &rows[table->first + index];
+    if(strcmp(row->macro, "KLI_ADD_SUBCOMMAND_TABLE") || !strcmp(row->fields[2], "NULL") || !strcmp(row->fields[2], "0"))
+        return NULL;
+    const Table *subcommands = find_table(row->fields[2], TABLE_COMMAND);
+    if(!subcommands)
+        fail("subcommand table '%s' not found", row->fields[2]);
+    return subcommands;
+}
+
+static int generate_flat(const char *root, const char *output) {
+    static FlatEntry entries[TABLEGEN_MAX_ENTRIES] = {0};
+    static const Table *spanTables[TABLEGEN_MAX_ENTRIES] = {0};
+    static int spanFirsts[TABLEGEN_MAX_ENTRIES] = {0};
+    int entryCount = 0, spanCount = 0, namesSize = 0;
+
+    // Find top level table
+    const Table *top = find_table(root, TABLE_COMMAND);
+    if(!top)
+        fail("top level table '%s' not found", root);
+
+    // Flatten tables breadth first, each table becoming a contiguous span
+    spanTables[spanCount++] = top;
+    for(int span = 0; span < spanCount; span++) {
+        const Table *table = spanTables[span];
+        spanFirsts[span] = entryCount;
+        if(entryCount + table->count > TABLEGEN_MAX_ENTRIES)
+            fail("too many entries under '%s'", root);
+
+        // Insert entries sorted by name
+        for(int i = 0; i < table->count; i++) {
+            int position = entryCount;
+            while(position > spanFirsts[span] && strcmp(row_name(table, i), row_name(entries[position - 1].table, entries[position - 1].index)) < 0) {
+                entries[position] = entries[position - 1];
+                --position;
+            }
+            entries[position] = (FlatEntry){table, i, namesSize, -1};
+            if(strlen(row_name(table, i)) > 255)
+                fail("command name '%s' too long", row_name(table, i));
+            namesSize += strlen(row_name(table, i)) + 1;
+            if(namesSize > TABLEGEN_MAX_NAMES)
+                fail("names pool too large under '%s'", root);
+            ++entryCount;
+        }
+
+        // Reject duplicated siblings, they would never be reachable
+        for(int i = spanFirsts[span] + 1; i < entryCount; i++)
+            if(!strcmp(row_name(entries[i].table, entries[i].index), row_name(entries[i - 1].table, entries[i - 1].index)))
+                fail("duplicated command name '%s'", row_name(entries[i].table, entries[i].index));
+
+        // Queue children spans
+        for(int i = spanFirsts[span]; i < entryCount; i++) {
+            const Table *subcommands = row_subcommands(entries[i].table, entries[i].index);
+            if(subcommands) {
+                entries[i].span = spanCount;
+                spanTables[spanCount++] = subcommands;
+            }
+        }
+    }
+
+    // Recompute name offsets once entries are sorted
+    namesSize = 0;
+    for(int i = 0; i < entryCount; i++) {
+        entries[i].name = namesSize;
+        namesSize += strlen(row_name(entries[i].table, entries[i].index)) + 1;
+    }
+
+    // Open output file
+    FILE *file = fopen(output, "w");
+    if(!file)
+        fail("cannot write '%s'", output);
+
+    // Header
+    fprintf(file, "/**\n * @file %s\n * @brief Flattened '%s' command table, generated by kli_tablegen. Do not edit.\n */\n\n", output, root);
+    fprintf(file, "// Includes\n\n#include \"kli.h\"\n\n");
+
+    // Source tables
+    fprintf(file, "// Source tables\n\n");
+    for(int i = 0; i < tableCount; i++)
+        if(tables[i].kind == TABLE_COMMAND)
+            fprintf(file, "KLI_EXPORT_COMMAND_TABLE(%s);\n", tables[i].name);
+
+    // Hot region, names pool
+    fprintf(file, "\n// Hot region\n\nstatic const char %s_FLAT_NAMES[] =", root);
+    for(int i = 0; i < entryCount; i++) {
+        fprintf(file, "\n    ");
+        emit_string(file, row_name(entries[i].table, entries[i].index));
+    }
+    fprintf(file, ";\n\n");
+
+    // Hot region, entries
+    fprintf(file, "static const KliFlatEntry %s_FLAT_ENTRIES[] = {\n", root);
+    for(int i = 0; i < entryCount; i++) {
+        const Row *row = &rows[entries[i].table->first + entries[i].index];
+        const char *flags = "0";
+        const char *handler = row->fields[row->count - 1];
+        if(entries[i].span >= 0)
+            flags = "KLI_FLAT_SUBCOMMANDS";
+        else if(strcmp(row->macro, "KLI_ADD_SUBCOMMAND_TABLE") && strcmp(handler, "NULL") && strcmp(handler, "0"))
+            flags = "KLI_FLAT_HANDLER";
+        fprintf(file, "    {%d, %zu, %s, %d},\n", entries[i].name, strlen(row->fields[0]), flags, entries[i].span < 0 ? 0 : entries[i].span);
+    }
+    fprintf(file, "};\n\n");
+
+    // Hot region, spans
+    fprintf(file, "static const KliFlatSpan %s_FLAT_SPANS[] = {\n", root);
+    for(int i = 0; i < spanCount; i++)
+        fprintf(file, "    {%d, %d, 0, 0, 0, 0},\n", spanFirsts[i], spanTables[i]->count);
+    fprintf(file, "};\n\n");
+
+    // Cold region, source entries
+    fprintf(file, "// Cold region\n\nstatic const KliCommand * const %s_FLAT_SOURCES[] = {\n", root);
+    for(int i = 0; i < entryCount; i++)
+        fprintf(file, "    &%s[%d],\n", entries[i].table->name, entries[i].index);
+    fprintf(file, "};\n\n");
+
+    // Flattened table
+    fprintf(file, "// Flattened table\n\n");
+    fprintf(file, "const KliFlatTable %s_FLAT = {%s_FLAT_NAMES, %s_FLAT_ENTRIES, %s_FLAT_SPANS, %s_FLAT_SOURCES, %s, NULL, NULL};\n", root, root, root, root, root, root);
+    fclose(file);
+    return EXIT_SUCCESS;
+}
+
+static int generate_ids(const char *root, const char *output) {
+
+    // Find top level table
+    const Table *top = find_table(root, TABLE_COMMAND);
+    if(!top)
+        fail("top level table '%s' not found", root);
+
+    // Open output file
+    FILE *file = fopen(output, "w");
+    if(!file)
+        fail("cannot write '%s'", output);
+
+    // Header, guarded by the sanitized output file name
+    char guard[TABLEGEN_MAX_TOKEN] = {0};
+    append_symbol(guard, strrchr(output, '/') ? strrchr(output, '/') + 1 : output);
+    for(char *c = guard; *c; c++)
+        *c = (char)toupper((unsigned char)*c);
+    fprintf(file, "/**\n * @file %s\n * @brief Binary frame identifiers and encoders of the '%s' commands, generated by kli_tablegen. Do not edit.\n */\n\n", output, root);
+    fprintf(file, "#ifndef %s\n#define %s\n\n", guard, guard);
+    fprintf(file, "// Includes\n\n#include \"kli_binary.h\"\n\n");
+
+    // Handlers, depth first
+    emit_ids(file, top, "", root);
+    fprintf(file, "#endif /* %s */\n", guard);
+    fclose(file);
+    return EXIT_SUCCESS;
+}
+
+static void emit_ids(FILE *file, const Table *table, const char *path, const char *symbol) {
+    static unsigned long ids[TABLEGEN_MAX_IDS] = {0};
+    static int idCount = 0;
+
+    for(int i = 0; i < table->count; i++) {
+        const Row *row = &rows[table->first + i];
+
+        // Extend path and symbol with the command name
+        char childPath[TABLEGEN_MAX_TOKEN] = {0};
+        char childSymbol[TABLEGEN_MAX_TOKEN] = {0};
+        snprintf(childPath, sizeof(childPath), "%s%s%s", path, path[0] ? " " : "", row->fields[0]);
+        snprintf(childSymbol, sizeof(childSymbol), "%s_", symbol);
+        append_symbol(childSymbol, row->fields[0]);
+
+        // Subtable -> its handlers
+        const Table *subcommands = row_subcommands(table, i);
+        if(subcommands) {
+            emit_ids(file, subcommands, childPath, childSymbol);
+            continue;
+        }
+
+        // Only parsed handlers are reachable through frames
+        const bool parsed = !strcmp(row->macro, "KLI_ADD_COMMAND_HANDLER") || !strcmp(row->macro, "KLI_ADD_CACHEABLE_COMMAND_HANDLER");
+        if(!parsed || !strcmp(row->fields[4], "NULL") || !strcmp(row->fields[4], "0"))
+            continue;
+
+        // Identifier, collisions would make a command unreachable
+        unsigned long id = TABLEGEN_ID_BASIS;
+        for(const char *c = childPath; *c; c++)
+            id = ((id ^ (unsigned char)*c) * TABLEGEN_ID_PRIME) & 0xFFFFFFFFul;
+        for(int j = 0; j < idCount; j++)
+            if(ids[j] == id)
+                fail("command identifier collision on '%s', rename the command", childPath);
+        if(idCount >= TABLEGEN_MAX_IDS)
+            fail("too many handlers under '%s'", childPath);
+        ids[idCount++] = id;
+
+        // Identifier and frame start
+        fprintf(file, "// %s\n\n", childPath);
+        fprintf(file, "#define %s_ID 0x%08lXu\n\n", childSymbol, id);
+        fprintf(file, "static inline void %s_begin(KliFrame *frame, unsigned char *data, int size) {\n", childSymbol);
+        fprintf(file, "    kli_frame_begin(frame, data, size, %s_ID);\n}\n\n", childSymbol);
+        emit_encoders(file, childSymbol, row);
+    }
+}
+
+static void emit_encoders(FILE *file, const char *symbol, const Row *handler) {
+
+    // Options, one call per value for options expecting several values
+    const char *optionTable = handler->fields[2];
+    if(strcmp(optionTable, "NULL") && strcmp(optionTable, "0")) {
+        const Table *options = find_table(optionTable, TABLE_OPTION);
+        if(!options)
+            fail("option table '%s' not found", optionTable);
+        for(int i = 0; i < options->count; i++) {
+            const Row *row = &rows[options->first + i];
+            const bool typed = !strcmp(row->macro, "KLI_ADD_TYPED_OPTION");
+            char name[TABLEGEN_MAX_TOKEN] = {0};
+            append_symbol(name, strcmp(row->fields[1], "NULL") && strcmp(row->fields[1], "0") ? row->fields[1] : row->fields[0]);
+            if(!strcmp(row->fields[2], "0")) {
+                fprintf(file, "static inline void %s_opt_%s(KliFrame *frame) {\n", symbol, name);
+                fprintf(file, "    kli_frame_flag(frame, %d);\n}\n\n", i);
+                continue;
+            }
+            const char *encoder = NULL;
+            const char *type = type_of(typed ? row->fields[3] : "KLI_TYPE_TEXT", &encoder);
+            fprintf(file, "static inline void %s_opt_%s(KliFrame *frame, %svalue) {\n", symbol, name, type);
+            fprintf(file, "    %s(frame, %d, value);\n}\n\n", encoder, i);
+        }
+    }
+
+    // Arguments
+    const char *argumentTable = handler->fields[3];
+    if(strcmp(argumentTable, "NULL") && strcmp(argumentTable, "0")) {
+        const Table *arguments = find_table(argumentTable, TABLE_ARGUMENT);
+        if(!arguments)
+            fail("argument table '%s' not found", argumentTable);
+        for(int i = 0; i < arguments->count; i++) {
+            const Row *row = &rows[arguments->first + i];
+            const bool typed = !strcmp(row->macro, "KLI_ADD_TYPED_ARGUMENT");
+            char name[TABLEGEN_MAX_TOKEN] = {0};
+            append_symbol(name, row->fields[0]);
+            const char *encoder = NULL;
+            const char *type = type_of(typed ? row->fields[1] : "KLI_TYPE_TEXT", &encoder);
+            fprintf(file, "static inline void %s_arg_%s(KliFrame *frame, %svalue) {\n", symbol, name, type);
+            fprintf(file, "    %s(frame, KLI_FRAME_ARGUMENT | %d, value);\n}\n\n", encoder, i);
+        }
+    }
+}
+
+static const char *type_of(const char *type, const char **encoder) {
+    if(!strcmp(type, "KLI_TYPE_TEXT") || !strcmp(type, "0")) {
+        *encoder = "kli_frame_text";
+        return "const char *";
+    }
+    if(!strcmp(type, "KLI_TYPE_INT") || !strcmp(type, "1")) {
+        *encoder = "kli_frame_int";
+        return "int32_t ";
+    }
+    if(!strcmp(type, "KLI_TYPE_FLOAT") || !strcmp(type, "2")) {
+        *encoder = "kli_frame_float";
+        return "float ";
+    }
+    fail("unknown value type '%s'", type);
+    return NULL;
+}
+
+static void append_symbol(char *symbol, const char *name) {
+
+    // Keep identifier characters, replace others, quotes of character literals are dropped
+    size_t length = strlen(symbol);
+    for(const char *c = name; *c && length < TABLEGEN_MAX_TOKEN - 1; c++) {
+        if(*c == '\'')
+            continue;
+        symbol[length++] = isalnum((unsigned char)*c) ? *c : '_';
+    }
+    symbol[length] = '\0';
+}
+
+static int generate_help(const char *root, const char *output, bool compressed) {
+
+    // Find top level table, built-in commands are listed by help too
+    const Table *top = find_table(root, TABLE_COMMAND);
+    if(!top)
+        fail("top level table '%s' not found", root);
+    const Table *builtin = find_table("KLI_BUILTIN", TABLE_COMMAND);
+    if(builtin)
+        collect_help(builtin, "");
+    collect_help(top, "");
+    if(!helpCount)
+        fail("no description under '%s'", root);
+
+    // Sort entries by key, equal keys of different strings would show wrong descriptions
+    for(int i = 1; i < helpCount; i++) {
+        HelpEntry entry = helpEntries[i];
+        int position = i;
+        while(position > 0 && helpEntries[position - 1].key > entry.key) {
+            helpEntries[position] = helpEntries[position - 1];
+            --position;
+        }
+        helpEntries[position] = entry;
+    }
+    for(int i = 1; i < helpCount; i++)
+        if(helpEntries[i].key == helpEntries[i - 1].key)
+            fail("help key collision on '%s', rename the command", helpEntries[i].path);
+
+    // Plain size, then pack descriptions if requested
+    int plainSize = 0;
+    for(int i = 0; i < helpTextCount; i++)
+        plainSize += helpLengths[i] + 1;
+    unsigned char pairs[256][2] = {{0}};
+    int first = 256, depth = 0;
+    const int codes = compressed ? compress_help(pairs, &first, &depth) : 0;
+
+    // Description offsets
+    static unsigned long offsets[TABLEGEN_MAX_HELP] = {0};
+    int dataSize = 0;
+    for(int i = 0; i < helpTextCount; i++) {
+        offsets[i] = dataSize;
+        dataSize += helpLengths[i] + 1;
+    }
+
+    // Open output file
+    FILE *file = fopen(output, "w");
+    if(!file)
+        fail("cannot write '%s'", output);
+
+    // Header
+    fprintf(file, "/**\n * @file %s\n * @brief Help blob of the '%s' commands, generated by kli_tablegen. Do not edit.\n", output, root);
+    fprintf(file, " * @note %d descriptions, %d bytes of text stored in %d bytes.\n */\n\n", helpCount, plainSize, dataSize + codes * 2);
+    fprintf(file, "// Includes\n\n#include \"kli.h\"\n\n");
+
+    // Keys and offsets
+    fprintf(file, "// Help blob\n\nstatic const uint32_t %s_HELP_KEYS[] KLI_HELP_PLACEMENT = {\n", root);
+    for(int i = 0; i < helpCount; i++)
+        fprintf(file, "    0x%08lXu, // %s\n", helpEntries[i].key, helpEntries[i].path);
+    fprintf(file, "};\n\nstatic const uint32_t %s_HELP_OFFSETS[] KLI_HELP_PLACEMENT = {\n", root);
+    for(int i = 0; i < helpCount; i++)
+        fprintf(file, "    %lu,\n", offsets[helpEntries[i].text]);
+
+    // Descriptions, one per line
+    fprintf(file, "};\n\nstatic const unsigned char %s_HELP_DATA[] KLI_HELP_PLACEMENT = {\n", root);
+    for(int i = 0; i < helpTextCount; i++) {
+        fprintf(file, "   ");
+        for(int j = 0; j < helpLengths[i]; j++)
+            fprintf(file, " %u,", helpTexts[i][j]);
+        fprintf(file, " 0,\n");
+    }
+    fprintf(file, "};\n\n");
+
+    // Pairs expanded by codes, and decoding stack check
+    if(codes) {
+        fprintf(file, "static const unsigned char %s_HELP_PAIRS[][2] KLI_HELP_PLACEMENT = {\n", root);
+        for(int i = 0; i < codes; i++)
+            fprintf(file, "    {%u, %u},\n", pairs[i][0], pairs[i][1]);
+        fprintf(file, "};\n\n");
+        fprintf(file, "typedef char %s_HELP_STACK_CHECK[KLI_HELP_STACK_SIZE > %d ? 1 : -1];\n\n", root, depth);
+    }
+
+    // Help blob
+    fprintf(file, "const KliHelp KLI_HELP = {%s_HELP_KEYS, %s_HELP_OFFSETS, %s_HELP_DATA, ", root, root, root);
+    if(codes)
+        fprintf(file, "%s_HELP_PAIRS, %d, %d};\n", root, first, helpCount);
+    else
+        fprintf(file, "NULL, 256, %d};\n", helpCount);
+    fclose(file);
+    return EXIT_SUCCESS;
+}
+
+static void collect_help(const Table *table, const char *path) {
+    for(int i = 0; i < table->count; i++) {
+        const Row *row = &rows[table->first + i];
+
+        // Command description, keyed by its path
+        char childPath[TABLEGEN_MAX_TOKEN] = {0};
+        snprintf(childPath, sizeof(childPath), "%s%s%s", path, path[0] ? " " : "", row->fields[0]);
+        add_help(childPath, "", "", row->fields[1]);
+
+        // Subtable -> its commands
+        const Table *subcommands = row_subcommands(table, i);
+        if(subcommands) {
+            collect_help(subcommands, childPath);
+            continue;
+        }
+        if(!strcmp(row->macro, "KLI_ADD_SUBCOMMAND_TABLE"))
+            continue;
+
+        // Options, keyed by long name, or by short name without long name
+        const bool raw = !strcmp(row->macro, "KLI_ADD_RAW_COMMAND_HANDLER");
+        const char *optionTable = raw ? "NULL" : row->fields[2];
+        if(strcmp(optionTable, "NULL") && strcmp(optionTable, "0")) {
+            const Table *options = find_table(optionTable, TABLE_OPTION);
+            if(!options)
+                fail("option table '%s' not found", optionTable);
+            for(int j = 0; j < options->count; j++) {
+                const Row *option = &rows[options->first + j];
+                const char *description = option->fields[!strcmp(option->macro, "KLI_ADD_TYPED_OPTION") ? 4 : 3];
+                char shortName[2] = {option->fields[0][0] == '\'' ? option->fields[0][1] : '\0', '\0'};
+                if(strcmp(option->fields[1], "NULL") && strcmp(option->fields[1], "0"))
+                    add_help(childPath, " --", option->fields[1], description);
+                else
+                    add_help(childPath, " -", shortName, description);
+            }
+        }
+
+        // Arguments, keyed by name
+        const char *argumentTable = row->fields[raw ? 2 : 3];
+        if(strcmp(argumentTable, "NULL") && strcmp(argumentTable, "0")) {
+            const Table *arguments = find_table(argumentTable, TABLE_ARGUMENT);
+            if(!arguments)
+                fail("argument table '%s' not found", argumentTable);
+            for(int j = 0; j < arguments->count; j++) {
+                const Row *argument = &rows[arguments->first + j];
+                add_help(childPath, " ", argument->fields[0], argument->fields[!strcmp(argument->macro, "KLI_ADD_TYPED_ARGUMENT") ? 2 : 1]);
+            }
+        }
+    }
+}
+
+static void add_help(const char *path, const char *separator, const char *name, const char *description) {
+    if(!strcmp(description, "NULL") || !strcmp(description, "0"))
+        return;
+
+    // Key string, the first description of a key wins like the first matching entry at dispatch
+    char keyPath[TABLEGEN_MAX_TOKEN] = {0};
+    snprintf(keyPath, sizeof(keyPath), "%s%s%s", path, separator, name);
+    for(int i = 0; i < helpCount; i++)
+        if(!strcmp(helpEntries[i].path, keyPath))
+            return;
+    if(helpCount >= TABLEGEN_MAX_HELP)
+        fail("too many descriptions under '%s'", path);
+
+    // Key, hash of the key string
+    unsigned long key = TABLEGEN_ID_BASIS;
+    for(const char *c = keyPath; *c; c++)
+        key = ((key ^ (unsigned char)*c) * TABLEGEN_ID_PRIME) & 0xFFFFFFFFul;
+
+    // Share identical descriptions
+    const int length = (int)strlen(description);
+    int text = 0;
+    while(text < helpTextCount && (helpLengths[text] != length || memcmp(helpTexts[text], description, length)))
+        ++text;
+    if(text == helpTextCount) {
+        helpTexts[text] = (unsigned char *)strdup(description);
+        helpLengths[text] = length;
+        ++helpTextCount;
+    }
+    helpEntries[helpCount++] = (HelpEntry){key, strdup(keyPath), text};
+}
+
+static int compress_help(unsigned char pairs[][2], int *first, int *depth) {
+    static int counts[256 * 256] = {0};
+    int depths[256] = {0};
+
+    // Codes start after the highest byte used by descriptions
+    *first = 1;
+    for(int i = 0; i < helpTextCount; i++)
+        for(int j = 0; j < helpLengths[i]; j++)
+            *first = helpTexts[i][j] + 1 > *first ? helpTexts[i][j] + 1 : *first;
+    *depth = 0;
+
+    // Replace the most frequent pair by a new code, while it saves more than its dictionary entry
+    int code = *first;
+    for(; code < 256; code++) {
+        memset(counts, 0, sizeof(counts));
+        for(int i = 0; i < helpTextCount; i++)
+            for(int j = 0; j + 1 < helpLengths[i]; j++)
+                ++counts[helpTexts[i][j] << 8 | helpTexts[i][j + 1]];
+        int best = -1;
+        for(int pair = 0; pair < 256 * 256; pair++) {
+            const int pairDepth = 1 + (depths[pair >> 8] > depths[pair & 0xFF] ? depths[pair >> 8] : depths[pair & 0xFF]);
+            if(counts[pair] >= 3 && pairDepth <= TABLEGEN_HELP_DEPTH && (best < 0 || counts[pair] > counts[best]))
+                best = pair;
+        }
+        if(best < 0)
+            break;
+
+        // Record pair, then replace its occurrences left to right
+        pairs[code - *first][0] = (unsigned char)(best >> 8);
+        pairs[code - *first][1] = (unsigned char)(best & 0xFF);
+        depths[code] = 1 + (depths[best >> 8] > depths[best & 0xFF] ? depths[best >> 8] : depths[best & 0xFF]);
+        *depth = depths[code] > *depth ? depths[code] : *depth;
+        for(int i = 0; i < helpTextCount; i++) {
+            int length = 0;
+            for(int j = 0; j < helpLengths[i]; j++) {
+                if(j + 1 < helpLengths[i] && (helpTexts[i][j] << 8 | helpTexts[i][j + 1]) == best)
+                    helpTexts[i][length++] = (unsigned char)code, ++j;
+                else
+                    helpTexts[i][length++] = helpTexts[i][j];
+            }
+            helpLengths[i] = length;
+        }
+    }
+
+    // No code used -> plain blob
+    const int codes = code - *first;
+    if(!codes)
+        *first = 256;
+    return codes;
+}
+
+static void emit_string(FILE *file, const char *string) {
+
+    // Escape characters which can't be written as is, and terminate with an explicit null
+    fputc('"', file);
+    for(const char *c = string; *c; c++) {
+        if(*c == '"' || *c == '\\')
+            fprintf(file, "\\%c", *c);
+        else if(isprint((unsigned char)*c))
+            fputc(*c, file);
+        else
+            fprintf(file, "\\%03o", (unsigned char)*c);
+    }
+    fprintf(file, "\\0\"");
+}
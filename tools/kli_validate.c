@@ -0,0 +1,266 @@
+/**
+ * @file kli_validate.c
+ * @author Killian Baillifard
+ * @date 18.10.2026
+ * @brief KLI script validator, host program checking each line of a command script without calling any handler.
+ * @note Build with the library and the table sources, defining the top level table and thread local storage, e.g.
+ *       'cc -O2 -pthread -DKLI_THREAD_LOCAL=_Thread_local -DKLI_VALIDATE_TABLE=COMMANDS -Iinclude -o kli_validate tools/kli_validate.c source/kli_*.c commands.c'.
+ * @note Usage : 'kli_validate <script> [threads]', errors are printed as '<script>:<line>: <error>' in line order.
+ * @note The script is memory mapped and split in one chunk per thread, blank lines and lines starting with '#' are skipped.
+ * @note Macros defined anywhere in the script are collected first, so the chunks accept calls to them.
+ */
+
+// Includes
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "kli.h"
+
+// Definitions
+
+#ifndef KLI_VALIDATE_TABLE
+#define KLI_VALIDATE_TABLE              COMMANDS        // Top level table the script is checked against.
+#endif
+#define VALIDATE_MAX_THREADS            256             // Maximum number of threads.
+
+// Structures
+
+/**
+ * @brief Invalid line.
+ */
+typedef struct LineError {
+
+    // Line number in the chunk, from 1.
+    long line;
+
+    // Error message.
+    char *message;
+
+} LineError;
+
+/**
+ * @brief Chunk of the script checked by one thread.
+ */
+typedef struct Chunk {
+
+    // First character, at the start of a line.
+    const char *begin;
+
+    // Character after the last one.
+    const char *end;
+
+    // Number of lines of the chunk.
+    long lines;
+
+    // Invalid lines, in line order.
+    LineError *errors;
+
+    // Number of invalid lines.
+    long errorCount;
+
+    // Capacity of the errors array.
+    long errorCapacity;
+
+} Chunk;
+
+// Variables
+
+KLI_EXPORT_COMMAND_TABLE(KLI_VALIDATE_TABLE);
+static char **macros = NULL;
+static int macroCount = 0;
+static int macroCapacity = 0;
+
+// Static prototypes
+
+static void *validate_chunk(void *argument);
+static void add_error(Chunk *chunk, long line, const char *message);
+static void collect_macros(const char *text, size_t size);
+static int compare_names(const void *first, const void *second);
+
+// Implementations
+
+int main(int argc, char **argv) {
+
+    // Check usage
+    if(argc < 2 || argc > 3) {
+        fprintf(stderr, "usage : %s <script> [threads]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    long threads = argc == 3 ? strtol(argv[2], NULL, 10) : sysconf(_SC_NPROCESSORS_ONLN);
+    threads = threads < 1 ? 1 : threads > VALIDATE_MAX_THREADS ? VALIDATE_MAX_THREADS : threads;
+
+    // Map script
+    int file = open(argv[1], O_RDONLY);
+    struct stat status;
+    if(file < 0 || fstat(file, &status)) {
+        fprintf(stderr, "kli_validate : cannot open '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    const size_t size = status.st_size;
+    if(!size)
+        return EXIT_SUCCESS;
+    const char *text = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if(text == MAP_FAILED) {
+        fprintf(stderr, "kli_validate : cannot map '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    posix_madvise((void *)text, size, POSIX_MADV_SEQUENTIAL);
+
+    // Collect macro names before splitting, a macro may be called from another chunk
+    collect_macros(text, size);
+    qsort(macros, macroCount, sizeof(char *), compare_names);
+    kli_validate_macros((const char * const *)macros, macroCount);
+
+    // Split in chunks of equal size, moved to the next line start
+    static Chunk chunks[VALIDATE_MAX_THREADS] = {0};
+    static pthread_t workers[VALIDATE_MAX_THREADS];
+    const char *begin = text;
+    for(long i = 0; i < threads; i++) {
+        const char *end = i == threads - 1 ? text + size : text + size * (i + 1) / threads;
+        if(end < begin)
+            end = begin;
+        const char *newline = end < text + size ? memchr(end, '\n', text + size - end) : NULL;
+        end = newline ? newline + 1 : text + size;
+        chunks[i].begin = begin;
+        chunks[i].end = end;
+        begin = end;
+    }
+
+    // Check chunks in parallel, the library keeps its state per thread
+    for(long i = 0; i < threads; i++)
+        if(pthread_create(&workers[i], NULL, validate_chunk, &chunks[i])) {
+            fprintf(stderr, "kli_validate : cannot start thread\n");
+            return EXIT_FAILURE;
+        }
+    for(long i = 0; i < threads; i++)
+        pthread_join(workers[i], NULL);
+
+    // Report errors in line order, chunk line numbers are offset by the previous chunks
+    long offset = 0, errors = 0;
+    for(long i = 0; i < threads; i++) {
+        for(long j = 0; j < chunks[i].errorCount; j++)
+            printf("%s:%ld: %s\n", argv[1], offset + chunks[i].errors[j].line, chunks[i].errors[j].message);
+        offset += chunks[i].lines;
+        errors += chunks[i].errorCount;
+    }
+    if(errors)
+        fprintf(stderr, "kli_validate : %ld invalid line(s) out of %ld\n", errors, offset);
+    munmap((void *)text, size);
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+__attribute__((weak)) void kli_out(const char *string, int length) {
+
+    // Validation never flushes output, table sources may define their own output
+    (void)string;
+    (void)length;
+}
+
+// Static definitions
+
+static void *validate_chunk(void *argument) {
+    Chunk * const chunk = argument;
+    char line[KLI_MAX_LINE_SIZE];
+
+    for(const char *cursor = chunk->begin; cursor < chunk->end;) {
+
+        // Find line end, without its carriage return
+        const char *newline = memchr(cursor, '\n', chunk->end - cursor);
+        const char *end = newline ? newline : chunk->end;
+        size_t length = end - cursor;
+        if(length && cursor[length - 1] == '\r')
+            --length;
+        const long number = ++chunk->lines;
+        const char *start = cursor;
+        cursor = newline ? newline + 1 : chunk->end;
+
+        // Skip blank and comment lines
+        size_t blank = 0;
+        while(blank < length && (start[blank] == ' ' || start[blank] == '\t'))
+            ++blank;
+        if(blank == length || start[blank] == '#')
+            continue;
+
+        // Split a copy of the line, as the device would
+        if(length >= KLI_MAX_LINE_SIZE) {
+            add_error(chunk, number, "line too long");
+            continue;
+        }
+        memcpy(line, start, length);
+        line[length] = '\0';
+        char *tokens[KLI_MAX_ARGC] = {NULL};
+        int count = kli_parse_line(line, tokens);
+
+        // Check commands
+        const char *error = kli_validate(KLI_VALIDATE_TABLE, count, tokens);
+        if(error)
+            add_error(chunk, number, error);
+    }
+    return NULL;
+}
+
+static void add_error(Chunk *chunk, long line, const char *message) {
+
+    // Grow errors array
+    if(chunk->errorCount == chunk->errorCapacity) {
+        chunk->errorCapacity = chunk->errorCapacity ? chunk->errorCapacity * 2 : 64;
+        chunk->errors = realloc(chunk->errors, chunk->errorCapacity * sizeof(LineError));
+        if(!chunk->errors) {
+            fprintf(stderr, "kli_validate : out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    chunk->errors[chunk->errorCount++] = (LineError){line, strdup(message)};
+}
+
+static void collect_macros(const char *text, size_t size) {
+    const size_t commandLength = strlen(KLI_MACRO_COMMAND);
+    char line[KLI_MAX_LINE_SIZE];
+
+    for(const char *cursor = text; cursor < text + size;) {
+        const char *newline = memchr(cursor, '\n', text + size - cursor);
+        const char *end = newline ? newline : text + size;
+        const char *start = cursor;
+        cursor = newline ? newline + 1 : text + size;
+
+        // Only split lines whose first word may name the macro built-in, i.e. is a prefix of it
+        while(start < end && (*start == ' ' || *start == '\t'))
+            ++start;
+        size_t word = 0;
+        while(start + word < end && start[word] != ' ' && start[word] != '\t' && start[word] != '\r')
+            ++word;
+        size_t length = end - start;
+        if(!word || word > commandLength || strncmp(start, KLI_MACRO_COMMAND, word) || length >= KLI_MAX_LINE_SIZE)
+            continue;
+        memcpy(line, start, length);
+        line[length] = '\0';
+        char *tokens[KLI_MAX_ARGC] = {NULL};
+        int count = kli_parse_line(line, tokens);
+
+        // Name followed by commands -> definition, a name alone removes the macro
+        if(count < 3 || !kli_defines_macro(KLI_VALIDATE_TABLE, count, tokens))
+            continue;
+        if(macroCount == macroCapacity) {
+            macroCapacity = macroCapacity ? macroCapacity * 2 : 64;
+            macros = realloc(macros, macroCapacity * sizeof(char *));
+            if(!macros) {
+                fprintf(stderr, "kli_validate : out of memory\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        macros[macroCount++] = strdup(tokens[1]);
+    }
+}
+
+static int compare_names(const void *first, const void *second) {
+    return strcmp(*(char * const *)first, *(char * const *)second);
+}